@@ -22,6 +22,7 @@
 #include "eckit/runtime/Main.h"
 
 #include "multio/LibMultio.h"
+#include "multio/util/Tracing.h"
 #include "multio/util/logfile_name.h"
 
 using eckit::LocalConfiguration;
@@ -38,6 +39,7 @@ using eckit::Log;
 
 Action::Action(const ConfigurationContext& confCtx) :
     FailureAware(confCtx), confCtx_(confCtx), type_{confCtx.config().getString("type")} {
+    statistics_.latency_ = &util::Metrics::instance().histogram("action_latency", {{"action", type_}});
     if (confCtx.config().has("next")) {
         const ConfigurationContext nextCtx = confCtx.subContext("next", util::ComponentTag::Action);
         next_.reset(ActionFactory::instance().build(nextCtx.config().getString("type"), nextCtx));
@@ -59,12 +61,18 @@ void Action::executeNext(message::Message msg) const {
 }
 
 void Action::execute(message::Message msg) const {
+    util::TraceSpan span{type_.c_str(), msg.header().traceId()};
+    // Not holding on to the payload lets the action modify it in place
+    const auto described = msg.withoutPayload();
+    // One latency sample per message, over all timed parts of the action but not the actions downstream
+    const auto before = statistics_.actionTiming_;
     withFailureHandling([&]() { executeImpl(std::move(msg)); },
-                        [&, msg]() {
+                        [&]() {
                             std::ostringstream oss;
-                            oss << *this << " with Message: " << msg;
+                            oss << *this << " with Message: " << described;
                             return oss.str();
                         });
+    statistics_.latency_->recordSeconds((statistics_.actionTiming_ - before).elapsed_);
 }
 
 util::FailureHandlerResponse Action::handleFailure(util::OnActionError t, const util::FailureContext&,
@@ -84,6 +92,10 @@ void Action::activeCategories(std::insert_iterator<std::set<std::string>>& ins)
     return;
 }
 
+bool Action::selection(std::string&, std::vector<std::string>&) const {
+    return false;
+}
+
 void Action::computeActiveFields(std::insert_iterator<std::set<std::string>>& ins) const {
     activeFields(ins);
     if (!next_) {
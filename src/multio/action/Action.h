@@ -20,6 +20,8 @@
 #include <memory>
 #include <map>
 #include <set>
+#include <string>
+#include <vector>
 #include <iterator>
 #include <mutex>
 
@@ -63,6 +65,10 @@ public:
     virtual void activeFields(std::insert_iterator<std::set<std::string>>& ins) const;
     virtual void activeCategories(std::insert_iterator<std::set<std::string>>& ins) const;
 
+    // Implemented by selecting actions: messages are only passed on if the metadata value for `key` is
+    // one of `items`. Used for routing messages to plans.
+    virtual bool selection(std::string& key, std::vector<std::string>& items) const;
+
     // Computes all active fields of this and following actions
     void computeActiveFields(std::insert_iterator<std::set<std::string>>& ins) const;
     void computeActiveCategories(std::insert_iterator<std::set<std::string>>& ins) const;
@@ -6,6 +6,8 @@
 
 #include <eckit/log/Statistics.h>
 
+#include "multio/util/Metrics.h"
+
 namespace multio {
 namespace action {
 
@@ -16,6 +18,10 @@ public:
     eckit::Timing actionTiming_;
     eckit::Timer localTimer_; // Remove it once eckit::Statistics is fixed
 
+    // Latency distribution, shared by all actions of the same type. Recorded once per message by
+    // Action::execute, from the time added to actionTiming_.
+    util::Histogram* latency_ = nullptr;
+
     void report(std::ostream& out, const std::string& type = "Action",
                 const char* indent = "") const;
 };
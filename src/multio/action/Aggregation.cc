@@ -17,6 +17,7 @@
 
 #include "multio/LibMultio.h"
 #include "multio/domain/Mappings.h"
+#include "multio/util/MemoryAccount.h"
 #include "multio/util/ScopedTimer.h"
 
 namespace multio {
@@ -38,7 +39,10 @@ void Aggregation::executeImpl(Message msg) const {
 
 bool Aggregation::handleField(const Message& msg) const {
     util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
-    messages_[msg.fieldId()].push_back(msg);
+    util::MemoryAccount::get("aggregation").add(msg.size());
+    auto& parts = messages_[msg.fieldId()];
+    parts.push_back(msg);
+    parts.back().materialisePayload();
     return allPartsArrived(msg);
 }
 
@@ -49,7 +53,12 @@ bool Aggregation::handleFlush(const Message& msg) const {
         flushes_[msg.fieldId()] = 0;
     }
 
-    return ++flushes_.at(msg.fieldId()) == domain::Mappings::instance().get(msg.domain()).size();
+    if (++flushes_.at(msg.fieldId()) != domain::Mappings::instance().get(msg.domain()).size()) {
+        return false;
+    }
+
+    util::MemoryAccount::reportStep(msg.fieldId());
+    return true;
 }
 
 bool Aggregation::allPartsArrived(const Message& msg) const {
@@ -69,7 +78,7 @@ Message Aggregation::createGlobalField(const Message& msg) const {
     auto md = msg.header().metadata();
     Message msgOut{
         Message::Header{msg.header().tag(), Peer{msg.source().group()}, Peer{msg.destination()}, std::move(md)},
-        eckit::Buffer{msg.globalSize() * sizeof(double)}};
+        eckit::Buffer{msg.globalSize() * Message::sizeOf(msg.precision())}};
 
     domain::Mappings::instance().checkDomainConsistency(messages_.at(fid));
 
@@ -77,6 +86,12 @@ Message Aggregation::createGlobalField(const Message& msg) const {
         domain::Mappings::instance().get(msg.domain()).at(msg.source())->to_global(msg, msgOut);
     }
 
+    size_t bytes = 0;
+    for (const auto& msg : messages_.at(fid)) {
+        bytes += msg.size();
+    }
+    util::MemoryAccount::get("aggregation").remove(bytes, messages_.at(fid).size());
+
     messages_.erase(fid);
 
     return msgOut;
@@ -0,0 +1,266 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "BitRounding.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include "eckit/config/Configuration.h"
+#include "eckit/exception/Exceptions.h"
+
+#include "multio/LibMultio.h"
+#include "multio/util/ScopedTimer.h"
+
+namespace multio {
+namespace action {
+
+using message::Message;
+
+namespace {
+
+template <typename T>
+struct FloatBits;
+
+template <>
+struct FloatBits<double> {
+    using Int = uint64_t;
+    enum : long { width = 64, mantissaBits = 52 };
+};
+
+template <>
+struct FloatBits<float> {
+    using Int = uint32_t;
+    enum : long { width = 32, mantissaBits = 23 };
+};
+
+// Confidence with which the information of a bit must be distinguishable from that of random bits
+const double significance = 2.576;  // 99%
+
+long getKeepBits(const eckit::Configuration& conf) {
+    if (conf.has("keep-bits")) {
+        const auto keepBits = conf.getLong("keep-bits");
+        if (keepBits < 0) {
+            throw eckit::UserError("Action bit-rounding needs a non-negative number of keep-bits", Here());
+        }
+        return keepBits;
+    }
+    if (conf.has("information")) {
+        const auto information = conf.getDouble("information");
+        if (not(information > 0.0 && information <= 1.0)) {
+            throw eckit::UserError("Action bit-rounding needs an information fraction in (0, 1]", Here());
+        }
+        return -1;
+    }
+    throw eckit::UserError("Action bit-rounding needs either keep-bits or information", Here());
+}
+
+double entropy(double p) {
+    return (p > 0.0 && p < 1.0) ? -p * std::log2(p) - (1.0 - p) * std::log2(1.0 - p) : 0.0;
+}
+
+double mutualInformationTerm(double joint, double independent) {
+    return joint > 0.0 ? joint * std::log2(joint / independent) : 0.0;
+}
+
+template <typename T>
+void roundMantissaImpl(T* values, size_t count, long keepBits, T missingValue) {
+    using Int = typename FloatBits<T>::Int;
+    const long mantissaBits = FloatBits<T>::mantissaBits;
+    const long width = FloatBits<T>::width;
+
+    if (keepBits >= mantissaBits) {
+        return;
+    }
+
+    const auto shift = static_cast<unsigned>(mantissaBits - (keepBits > 0 ? keepBits : 0));
+    const Int dropped = (Int{1} << shift) - 1;
+    const Int half = dropped >> 1;
+    const Int exponent = ((Int{1} << (width - 1 - mantissaBits)) - 1) << mantissaBits;
+
+    // Branch-free, for the compiler to vectorise. Adding half the dropped range, plus one if the last kept bit
+    // is set, rounds to nearest with ties to even; a carry into the exponent rounds up to the next power of two.
+    for (size_t i = 0; i != count; ++i) {
+        const T v = values[i];
+        Int u;
+        std::memcpy(&u, &v, sizeof(u));
+
+        const Int rounded = (u + half + ((u >> shift) & 1)) & ~dropped;
+        const bool keep = ((u & exponent) == exponent) || (v == missingValue);
+        u = keep ? u : rounded;
+
+        std::memcpy(&values[i], &u, sizeof(u));
+    }
+}
+
+template <typename T>
+long keepBitsImpl(const T* values, size_t count, double information, T missingValue) {
+    using Int = typename FloatBits<T>::Int;
+    const long mantissaBits = FloatBits<T>::mantissaBits;
+    const long width = FloatBits<T>::width;
+
+    // Per bit position, how often it is set in the first and the second value of adjacent pairs and in both
+    uint64_t first[width] = {};
+    uint64_t second[width] = {};
+    uint64_t both[width] = {};
+    uint64_t pairs = 0;
+
+    Int previous = 0;
+    bool hasPrevious = false;
+    for (size_t i = 0; i != count; ++i) {
+        const T v = values[i];
+        if (v == missingValue) {
+            hasPrevious = false;
+            continue;
+        }
+
+        Int u;
+        std::memcpy(&u, &v, sizeof(u));
+
+        if (hasPrevious) {
+            const Int common = previous & u;
+            for (long b = 0; b != width; ++b) {
+                first[b] += (previous >> b) & 1;
+                second[b] += (u >> b) & 1;
+                both[b] += (common >> b) & 1;
+            }
+            ++pairs;
+        }
+
+        previous = u;
+        hasPrevious = true;
+    }
+
+    if (pairs < 2) {
+        return mantissaBits;
+    }
+
+    // Mutual information of each bit with the same bit of the next value. What is not significantly more
+    // than for random bits counts as none.
+    const double n = static_cast<double>(pairs);
+    const double freeEntropy = 1.0 - entropy(std::min(1.0, 0.5 + 0.5 * significance / std::sqrt(n)));
+
+    double bitInformation[width];
+    double total = 0.0;
+    for (long b = 0; b != width; ++b) {
+        const double px = first[b] / n;
+        const double py = second[b] / n;
+        const double p11 = both[b] / n;
+        const double p10 = px - p11;
+        const double p01 = py - p11;
+        const double p00 = 1.0 - p11 - p10 - p01;
+
+        const double mi = mutualInformationTerm(p00, (1.0 - px) * (1.0 - py))
+                        + mutualInformationTerm(p01, (1.0 - px) * py)
+                        + mutualInformationTerm(p10, px * (1.0 - py)) + mutualInformationTerm(p11, px * py);
+
+        bitInformation[b] = mi > freeEntropy ? mi : 0.0;
+        total += bitInformation[b];
+    }
+
+    if (!(total > 0.0)) {
+        return mantissaBits;
+    }
+
+    // Sign and exponent are always kept, the mantissa bits from the most significant on until enough
+    double kept = 0.0;
+    for (long b = mantissaBits; b != width; ++b) {
+        kept += bitInformation[b];
+    }
+
+    const double required = information * total * (1.0 - 1e-12);
+    long keepBits = 0;
+    while (kept < required && keepBits < mantissaBits) {
+        kept += bitInformation[mantissaBits - 1 - keepBits];
+        ++keepBits;
+    }
+
+    return keepBits;
+}
+
+}  // namespace
+
+void roundMantissa(double* values, size_t count, long keepBits, double missingValue) {
+    roundMantissaImpl(values, count, keepBits, missingValue);
+}
+
+void roundMantissa(float* values, size_t count, long keepBits, float missingValue) {
+    roundMantissaImpl(values, count, keepBits, missingValue);
+}
+
+long keepBitsForInformation(const double* values, size_t count, double information, double missingValue) {
+    return keepBitsImpl(values, count, information, missingValue);
+}
+
+long keepBitsForInformation(const float* values, size_t count, double information, float missingValue) {
+    return keepBitsImpl(values, count, information, missingValue);
+}
+
+BitRounding::BitRounding(const ConfigurationContext& confCtx) :
+    Action{confCtx},
+    keepBits_{getKeepBits(confCtx.config())},
+    information_{confCtx.config().getDouble("information", 0.99)} {}
+
+template <typename T>
+void BitRounding::roundValues(Message& msg) const {
+    // Without a bitmap, no value compares equal to NaN
+    const auto& md = msg.metadata();
+    const auto missingValue = md.getBool("bitmapPresent", false) ? static_cast<T>(md.getDouble("missingValue"))
+                                                                 : std::numeric_limits<T>::quiet_NaN();
+
+    auto values = static_cast<T*>(msg.payload().data());
+    const auto count = msg.size() / sizeof(T);
+
+    const auto keepBits
+        = keepBits_ < 0 ? keepBitsForInformation(values, count, information_, missingValue) : keepBits_;
+
+    LOG_DEBUG_LIB(LibMultio) << "*** Keeping " << keepBits << " mantissa bits of " << msg.name() << std::endl;
+
+    roundMantissa(values, count, keepBits, missingValue);
+}
+
+void BitRounding::executeImpl(Message msg) const {
+    if (msg.tag() == Message::Tag::Field) {
+        util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
+
+        switch (msg.precision()) {
+            case Message::Precision::Single:
+                roundValues<float>(msg);
+                break;
+            case Message::Precision::Double:
+                roundValues<double>(msg);
+                break;
+            default:
+                NOTIMP;
+        }
+    }
+
+    executeNext(std::move(msg));
+}
+
+void BitRounding::print(std::ostream& os) const {
+    os << "BitRounding(";
+    if (keepBits_ < 0) {
+        os << "information=" << information_;
+    }
+    else {
+        os << "keep-bits=" << keepBits_;
+    }
+    os << ")";
+}
+
+static ActionBuilder<BitRounding> BitRoundingBuilder("bit-rounding");
+
+}  // namespace action
+}  // namespace multio
@@ -0,0 +1,59 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Nov 2022
+
+/// Trims the precision of fields by rounding their values to a number of mantissa bits, so that the
+/// trailing bits are zero and compress well. The number of bits is either configured or derived per field
+/// from the bitwise real information content of its values (Klöwer et al., 2021): the bits are kept that
+/// hold a given fraction of the information, the others are considered noise.
+
+#ifndef multio_server_actions_BitRounding_H
+#define multio_server_actions_BitRounding_H
+
+#include <cstddef>
+#include <iosfwd>
+
+#include "multio/action/Action.h"
+
+namespace multio {
+namespace action {
+
+class BitRounding : public Action {
+public:
+    explicit BitRounding(const ConfigurationContext& confCtx);
+
+    void executeImpl(message::Message msg) const override;
+
+private:
+    template <typename T>
+    void roundValues(message::Message& msg) const;
+
+    void print(std::ostream& os) const override;
+
+    // Negative if derived from the information
+    const long keepBits_;
+    const double information_;
+};
+
+// Rounds to nearest, ties to even, keeping keepBits bits of the mantissa. Values equal to missingValue,
+// infinities and NaNs are left as they are.
+void roundMantissa(double* values, size_t count, long keepBits, double missingValue);
+void roundMantissa(float* values, size_t count, long keepBits, float missingValue);
+
+// Number of mantissa bits that hold the given fraction of the real information of the values, ignoring
+// those equal to missingValue. All the mantissa bits if no information can be measured.
+long keepBitsForInformation(const double* values, size_t count, double information, double missingValue);
+long keepBitsForInformation(const float* values, size_t count, double information, float missingValue);
+
+}  // namespace action
+}  // namespace multio
+
+#endif
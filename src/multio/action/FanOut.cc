@@ -0,0 +1,66 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "FanOut.h"
+
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/exception/Exceptions.h"
+
+#include "multio/action/Plan.h"
+
+namespace multio {
+namespace action {
+
+FanOut::FanOut(const ConfigurationContext& confCtx) : Action{confCtx} {
+    if (next_) {
+        throw eckit::UserError("Action fan-out must be the last action of its chain", Here());
+    }
+
+    const auto branches = confCtx.config().getSubConfigurations("branches");
+    if (branches.empty()) {
+        throw eckit::UserError("Action fan-out must define at least one branch", Here());
+    }
+
+    for (const auto& branch : branches) {
+        auto root = rootConfig(branch);
+        branches_.emplace_back(
+            ActionFactory::instance().build(root.getString("type"), confCtx.recast(root, util::ComponentTag::Action)));
+    }
+}
+
+void FanOut::executeImpl(message::Message msg) const {
+    // Branches that modify the payload work on a copy of their own, unless the others are done with it
+    for (size_t i = 0; i + 1 < branches_.size(); ++i) {
+        branches_[i]->execute(msg.share());
+    }
+    branches_.back()->execute(std::move(msg));
+}
+
+void FanOut::activeFields(std::insert_iterator<std::set<std::string>>& ins) const {
+    for (const auto& branch : branches_) {
+        branch->computeActiveFields(ins);
+    }
+}
+
+void FanOut::activeCategories(std::insert_iterator<std::set<std::string>>& ins) const {
+    for (const auto& branch : branches_) {
+        branch->computeActiveCategories(ins);
+    }
+}
+
+void FanOut::print(std::ostream& os) const {
+    os << "FanOut(branches=" << branches_.size() << ")";
+}
+
+
+static ActionBuilder<FanOut> FanOutBuilder("fan-out");
+
+}  // namespace action
+}  // namespace multio
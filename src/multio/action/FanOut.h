@@ -0,0 +1,47 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2022
+
+/// Ends a chain of actions by passing every message on to several branches, each a chain of actions of
+/// its own. The branches share the payload, so that the actions in front of the fan-out (e.g.
+/// aggregation and masking) run only once for all of them.
+
+#ifndef multio_server_actions_FanOut_H
+#define multio_server_actions_FanOut_H
+
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+#include "multio/action/Action.h"
+
+namespace multio {
+namespace action {
+
+class FanOut : public Action {
+public:
+    explicit FanOut(const ConfigurationContext& confCtx);
+
+    void executeImpl(message::Message msg) const override;
+
+    void activeFields(std::insert_iterator<std::set<std::string>>& ins) const override;
+    void activeCategories(std::insert_iterator<std::set<std::string>>& ins) const override;
+
+private:
+    void print(std::ostream& os) const override;
+
+    std::vector<std::unique_ptr<Action>> branches_;
+};
+
+}  // namespace action
+}  // namespace multio
+
+#endif
@@ -14,15 +14,19 @@
 
 #include "GribEncoder.h"
 
+#include <cstdlib>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <vector>
 
+#include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/log/Log.h"
 
 #include "multio/LibMultio.h"
 #include "multio/action/GridInfo.h"
+#include "multio/action/SimplePacking.h"
 #include "multio/util/Metadata.h"
 
 
@@ -60,6 +64,39 @@ const std::map<const std::string, const std::string> category_to_levtype{
 const std::map<const std::string, const long> type_of_generating_process{{"an", 0}, {"in", 1}, {"fc", 2}, {"pf", 4}};
 
 
+// Big-endian GRIB integers, signed ones with a sign bit followed by the magnitude
+uint64_t readUnsigned(const unsigned char* p, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i != bytes; ++i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+void writeUnsigned(unsigned char* p, uint64_t value, size_t bytes) {
+    for (size_t i = bytes; i != 0; --i) {
+        p[i - 1] = static_cast<unsigned char>(value & 0xff);
+        value >>= 8;
+    }
+}
+
+void writeSigned(unsigned char* p, long value, size_t bytes) {
+    writeUnsigned(p, static_cast<uint64_t>(std::labs(value)), bytes);
+    if (value < 0) {
+        p[0] |= 0x80;
+    }
+}
+
+long getLong(codes_handle* h, const char* key, long fallback) {
+    long value = fallback;
+    return codes_get_long(h, key, &value) == 0 ? value : fallback;
+}
+
+double getDouble(codes_handle* h, const char* key, double fallback) {
+    double value = fallback;
+    return codes_get_double(h, key, &value) == 0 ? value : fallback;
+}
+
 struct ValueSetter {
     GribEncoder& g_;
     std::string key_;
@@ -73,7 +110,10 @@ struct ValueSetter {
 }  // namespace
 
 GribEncoder::GribEncoder(codes_handle* handle, const eckit::LocalConfiguration& config) :
-    metkit::grib::GribHandle{handle}, config_{config} {
+    metkit::grib::GribHandle{handle},
+    config_{config},
+    nativePacking_{config_.getBool("native-packing",
+                                   eckit::Resource<bool>("multioNativeGribPacking;$MULTIO_NATIVE_GRIB_PACKING", true))} {
     for (auto const& subtype : {"T grid", "U grid", "V grid", "W grid", "F grid"}) {
         grids().insert(std::make_pair(subtype, std::unique_ptr<GridInfo>{new GridInfo{}}));
     }
@@ -329,26 +369,118 @@ message::Message GribEncoder::encodeField(const message::Metadata& md, const dou
 }
 
 message::Message GribEncoder::setFieldValues(const message::Message& msg) {
+    if (msg.precision() == Message::Precision::Single) {
+        // Single-precision fields are only converted here, for eccodes
+        auto beg = reinterpret_cast<const float*>(msg.payload().data());
+        std::vector<double> values(beg, beg + msg.globalSize());
+        return Message{Message::Header{Message::Tag::Grib, Peer{msg.source().group()}, Peer{msg.destination()}},
+                       encodeValues(values.data(), values.size())};
+    }
+
     auto beg = reinterpret_cast<const double*>(msg.payload().data());
     // TODO refactor
     // this->setDataValues(beg, msg.metadata().has("globalSize") ? msg.globalSize() : msg.payload().size() /
     // sizeof(double));
-    this->setDataValues(beg, msg.globalSize());
-
-    eckit::Buffer buf{this->length()};
-    this->write(buf);
-
     return Message{Message::Header{Message::Tag::Grib, Peer{msg.source().group()}, Peer{msg.destination()}},
-                   std::move(buf)};
+                   encodeValues(beg, msg.globalSize())};
 }
 
 message::Message GribEncoder::setFieldValues(const double* values, size_t count) {
+    return Message{Message::Header{Message::Tag::Grib, Peer{}, Peer{}}, encodeValues(values, count)};
+}
+
+eckit::Buffer GribEncoder::encodeValues(const double* values, size_t count) {
+    eckit::Buffer buf{0};
+    if (nativePacking_ && encodeSimplePacking(values, count, buf)) {
+        return buf;
+    }
+
     this->setDataValues(values, count);
 
-    eckit::Buffer buf{this->length()};
-    this->write(buf);
+    eckit::Buffer encoded{this->length()};
+    this->write(encoded);
+    return encoded;
+}
+
+bool GribEncoder::encodeSimplePacking(const double* values, size_t count, eckit::Buffer& buf) {
+    auto h = raw();
+
+    char packingType[64] = {0};
+    size_t len = sizeof(packingType);
+    if (codes_get_string(h, "packingType", packingType, &len) != 0 || std::string{packingType} != "grid_simple") {
+        return false;
+    }
+
+    // Anything that makes ecCodes deviate from plain binary scaling of the values as given
+    if (getLong(h, "edition", 0) != 2 || getLong(h, "bitmapPresent", 0) != 0
+        || getLong(h, "decimalScaleFactor", 0) != 0 || getLong(h, "optimizeScaleFactor", 0) != 0
+        || getDouble(h, "scaleValuesBy", 1.0) != 1.0 || getDouble(h, "offsetValuesBy", 0.0) != 0.0
+        || std::getenv("ECCODES_GRIB_DATA_QUALITY_CHECKS") != nullptr) {
+        return false;
+    }
+
+    const long bitsPerValue = getLong(h, "bitsPerValue", 0);
+
+    SimplePacking packing;
+    if (not computeSimplePacking(values, count, bitsPerValue, packing)) {
+        return false;
+    }
+
+    // ecCodes lays out the message for a constant field without packing any values. Its data section is
+    // then replaced with the natively packed one.
+    if (zeros_.size() != count) {
+        zeros_.assign(count, 0.0);
+    }
+    this->setDataValues(zeros_.data(), count);
+
+    const void* message = nullptr;
+    size_t messageSize = 0;
+    CODES_CHECK(codes_get_message(h, &message, &messageSize), nullptr);
+    auto bytes = static_cast<const unsigned char*>(message);
+
+    // Sections 1 to 7 follow the 16 octets of section 0, each starting with its length and number
+    size_t section5 = 0;
+    size_t section7 = 0;
+    for (size_t pos = 16; pos + 5 <= messageSize && std::memcmp(bytes + pos, "7777", 4) != 0;) {
+        const auto sectionSize = static_cast<size_t>(readUnsigned(bytes + pos, 4));
+        ASSERT(sectionSize >= 5);
+        if (bytes[pos + 4] == 5) {
+            section5 = pos;
+        }
+        if (bytes[pos + 4] == 7) {
+            section7 = pos;
+        }
+        pos += sectionSize;
+    }
+    ASSERT(section5 != 0 && section7 != 0);
+    ASSERT(readUnsigned(bytes + section5 + 5, 4) == count);
+    ASSERT(readUnsigned(bytes + section5 + 9, 2) == 0);  // Data representation template 5.0
+
+    const size_t dataSize = packing.packedSize(count);
+    const size_t totalSize = section7 + 5 + dataSize + 4;
+
+    eckit::Buffer encoded{totalSize};
+    auto out = reinterpret_cast<unsigned char*>(encoded.data());
+
+    std::memcpy(out, bytes, section7);
+    writeUnsigned(out + 8, totalSize, 8);
+
+    writeUnsigned(out + section5 + 11, packing.referenceBits(), 4);
+    writeSigned(out + section5 + 15, packing.binaryScaleFactor, 2);
+    writeSigned(out + section5 + 17, packing.decimalScaleFactor, 2);
+    out[section5 + 19] = static_cast<unsigned char>(packing.bitsPerValue);
+
+    writeUnsigned(out + section7, 5 + dataSize, 4);
+    out[section7 + 4] = 7;
+    packSimple(values, count, packing, out + section7 + 5);
+
+    std::memcpy(out + totalSize - 4, "7777", 4);
+
+    // Encoding the constant field has reset it
+    setValue("bitsPerValue", bitsPerValue);
 
-    return Message{Message::Header{Message::Tag::Grib, Peer{}, Peer{}}, std::move(buf)};
+    buf.swap(encoded);
+    return true;
 }
 
 }  // namespace action
@@ -17,6 +17,8 @@
 
 #include "eccodes.h"
 
+#include <vector>
+
 #include "metkit/codes/GribHandle.h"
 #include "multio/message/Message.h"
 
@@ -61,8 +63,19 @@ private:
     message::Message setFieldValues(const  message::Message& msg);
     message::Message setFieldValues(const double* values, size_t count);
 
+    eckit::Buffer encodeValues(const double* values, size_t count);
+
+    // Packs grid_simple GRIB2 fields natively. Returns false, leaving the handle untouched, for anything
+    // that ecCodes has to pack.
+    bool encodeSimplePacking(const double* values, size_t count, eckit::Buffer& buf);
+
     const eckit::LocalConfiguration config_;
 
+    const bool nativePacking_;
+
+    // Values of a constant field, for which ecCodes lays out the message without packing anything
+    std::vector<double> zeros_;
+
     const std::set<std::string> coordSet_{"lat_T", "lon_T", "lat_U", "lon_U", "lat_V",
                                           "lon_V", "lat_W", "lon_W", "lat_F", "lon_F"};
 };
@@ -23,6 +23,7 @@
 #include "eckit/utils/ByteSwap.h"
 
 #include "multio/LibMultio.h"
+#include "multio/util/MemoryAccount.h"
 
 namespace multio {
 namespace action {
@@ -54,12 +55,14 @@ void GridInfo::setSubtype(const std::string& subtype) {
 void GridInfo::setLatitudes(message::Message msg) {
     ASSERT(latitudes_.size() == 0);
 
+    util::MemoryAccount::get("grid-info").add(msg.size());
     latitudes_ = msg;
 }
 
 void GridInfo::setLongitudes(message::Message msg) {
     ASSERT(longitudes_.size() == 0);
 
+    util::MemoryAccount::get("grid-info").add(msg.size());
     longitudes_ = msg;
 }
 
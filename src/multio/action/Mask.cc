@@ -10,6 +10,10 @@
 
 #include "Mask.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
 #include "eckit/config/Configuration.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/log/Log.h"
@@ -47,16 +51,15 @@ void Mask::executeImpl(message::Message msg) const {
 message::Message Mask::createMasked(message::Message msg) const {
     util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
 
-    if (applyBitmap_) {
-        applyMask(msg);
-    }
+    const auto missing = missingValue(msg.precision());
 
-    if (setContains(offsetFields_, msg.name())) {
-        applyOffset(msg);
+    auto offset = setContains(offsetFields_, msg.name());
+    if (applyBitmap_ || offset) {
+        applyMask(msg, offset, missing);
     }
 
     message::Metadata md{msg.metadata()};
-    md.set("missingValue", missingValue_);
+    md.set("missingValue", missing);
     md.set("bitmapPresent", true);
 
     message::Message maskedMsg{
@@ -66,35 +69,99 @@ message::Message Mask::createMasked(message::Message msg) const {
     return maskedMsg;
 }
 
-void Mask::applyMask(message::Message msg) const {
-    auto const& bkey = domain::Mask::key(msg.metadata());
-    auto const& bitmask = domain::Mask::instance().get(bkey);
-
-    ASSERT(bitmask.size() == msg.size() / sizeof(double));
+namespace {
+// Single pass over the field, one 64-bit mask word at a time. Words that are entirely land or entirely
+// sea are handled without inspecting the individual bits; the others use a branch-free select.
+template <typename T, bool Masked, bool Offset>
+void maskValues(const domain::Bitmask& bitmask, message::Message& msg, double missingValue, double offsetValue) {
+    ASSERT(bitmask.size() == msg.size() / sizeof(T));
+
+    const auto missing = static_cast<T>(missingValue);
+    const auto offset = static_cast<T>(offsetValue);
+    const auto& words = bitmask.words();
+    const auto wordBits = domain::Bitmask::wordBits;
+
+    auto values = static_cast<T*>(msg.payload().data());
+    const auto size = bitmask.size();
+
+    for (size_t w = 0; w != words.size(); ++w) {
+        auto word = words[w];
+        auto git = values + w * wordBits;
+        auto count = std::min(wordBits, size - w * wordBits);
+
+        if (word == ~uint64_t{0}) {
+            if (Offset) {
+                for (size_t i = 0; i != count; ++i) {
+                    git[i] += offset;
+                }
+            }
+        }
+        else if (word == 0) {
+            if (Masked) {
+                std::fill(git, git + count, missing);
+            }
+        }
+        else {
+            for (size_t i = 0; i != count; ++i) {
+                const bool wet = (word >> i) & 1u;
+                const auto val = Offset ? git[i] + offset : git[i];
+                git[i] = wet ? val : (Masked ? missing : git[i]);
+            }
+        }
+    }
+}
 
-    auto git = static_cast<double*>(msg.payload().data());
+// Offset without masking only touches the sea points
+template <typename T>
+void offsetValues(const domain::Bitmask& bitmask, message::Message& msg, double offsetValue) {
+    ASSERT(bitmask.size() == msg.size() / sizeof(T));
 
-    for (const auto bval : bitmask) {
-        if (not bval) {
-            *git = missingValue_;
-        }
-        ++git;
+    const auto offset = static_cast<T>(offsetValue);
+    auto values = static_cast<T*>(msg.payload().data());
+    for (auto idx : bitmask.wetPoints()) {
+        values[idx] += offset;
     }
 }
 
-void Mask::applyOffset(message::Message msg) const {
-    auto const& bkey = domain::Mask::key(msg.metadata());
-    auto const& bitmask = domain::Mask::instance().get(bkey);
+template <typename T>
+void applyMaskAndOffset(const domain::Bitmask& bitmask, message::Message& msg, bool masked, bool offset,
+                        double missingValue, double offsetValue) {
+    if (masked && offset) {
+        maskValues<T, true, true>(bitmask, msg, missingValue, offsetValue);
+    }
+    else if (masked) {
+        maskValues<T, true, false>(bitmask, msg, missingValue, offsetValue);
+    }
+    else if (offset) {
+        offsetValues<T>(bitmask, msg, offsetValue);
+    }
+}
+}  // namespace
 
-    ASSERT(bitmask.size() == msg.size() / sizeof(double));
+double Mask::missingValue(message::Message::Precision precision) const {
+    if (precision != message::Message::Precision::Single) {
+        return missingValue_;
+    }
 
-    auto git = static_cast<double*>(msg.payload().data());
+    // The default, the largest double, is out of range for floats. Clamp so that the value written into the
+    // payload and the one recorded in the metadata are the same.
+    const double limit = std::numeric_limits<float>::max();
+    return static_cast<float>(std::max(-limit, std::min(limit, missingValue_)));
+}
 
-    for (const auto bval : bitmask) {
-        if (bval) {
-            *git += offsetValue_;
-        }
-        ++git;
+void Mask::applyMask(message::Message& msg, bool offset, double missingValue) const {
+    auto const& bkey = domain::Mask::key(msg.metadata());
+    auto const bitmask = domain::Mask::instance().get(bkey);
+
+    switch (msg.precision()) {
+        case message::Message::Precision::Single:
+            applyMaskAndOffset<float>(*bitmask, msg, applyBitmap_, offset, missingValue, offsetValue_);
+            break;
+        case message::Message::Precision::Double:
+            applyMaskAndOffset<double>(*bitmask, msg, applyBitmap_, offset, missingValue, offsetValue_);
+            break;
+        default:
+            NOTIMP;
     }
 }
 
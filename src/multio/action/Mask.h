@@ -33,8 +33,10 @@ public:
 private:
     message::Message createMasked(message::Message msg) const;
 
-    void applyMask(message::Message msg) const;
-    void applyOffset(message::Message msg) const;
+    void applyMask(message::Message& msg, bool offset, double missingValue) const;
+
+    // The missing value as it is stored in a payload of the given precision
+    double missingValue(message::Message::Precision precision) const;
 
     void print(std::ostream& os) const override;
 
@@ -0,0 +1,267 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "NodeAggregation.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+#include "eckit/config/Configuration.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/mpi/Comm.h"
+
+#include "multio/LibMultio.h"
+#include "multio/util/ScopedTimer.h"
+
+namespace multio {
+namespace action {
+
+using message::Peer;
+
+namespace {
+
+const size_t leaderRank = 0;
+
+constexpr bool inRange(int32_t val, int32_t low, int32_t upp) {
+    return (low <= val) && (val < upp);
+}
+
+size_t elementSize(int count, long dataSize) {
+    if (dataSize == 0) {
+        ASSERT(count == 0);
+        return 0;
+    }
+    ASSERT(count % dataSize == 0);
+    return static_cast<size_t>(count / dataSize);
+}
+
+const eckit::mpi::Comm& nodeCommunicator(const eckit::Configuration& cfg) {
+    const auto name = cfg.getString("node-comm", "multio-node");
+    if (eckit::mpi::hasComm(name.c_str())) {
+        return eckit::mpi::comm(name.c_str());
+    }
+
+    // Split the client communicator by host. A hash collision merely merges the ranks of two hosts.
+    const auto parentName = cfg.getString("parent-comm", "multio-clients");
+    const auto& parent = eckit::mpi::hasComm(parentName.c_str()) ? eckit::mpi::comm(parentName.c_str())
+                                                                  : eckit::mpi::comm();
+    auto color = static_cast<int>(std::hash<std::string>{}(parent.processorName())
+                                  % static_cast<size_t>(std::numeric_limits<int>::max()));
+
+    return parent.split(color, name);
+}
+
+}  // namespace
+
+NodeAggregation::NodeAggregation(const ConfigurationContext& confCtx) :
+    Action(confCtx), nodeComm_{nodeCommunicator(confCtx.config())} {}
+
+void NodeAggregation::executeImpl(Message msg) const {
+    switch (msg.tag()) {
+        case Message::Tag::Domain: {
+            auto nodeMsg = gatherDomain(msg);
+            if (isLeader()) {
+                executeNext(std::move(nodeMsg));
+            }
+            return;
+        }
+        case Message::Tag::Mask:
+        case Message::Tag::Field: {
+            auto nodeMsg = gatherPartial(msg);
+            if (isLeader()) {
+                executeNext(std::move(nodeMsg));
+            }
+            return;
+        }
+        case Message::Tag::StepComplete: {
+            // The server counts one flush per partial domain
+            if (isLeader()) {
+                executeNext(std::move(msg));
+            }
+            return;
+        }
+        default:
+            executeNext(std::move(msg));
+    }
+}
+
+bool NodeAggregation::isLeader() const {
+    return nodeComm_.rank() == leaderRank;
+}
+
+std::vector<char> NodeAggregation::gatherPayload(const Message& msg, std::vector<int>& counts) const {
+    counts.resize(nodeComm_.size());
+    nodeComm_.gather(static_cast<int>(msg.size()), counts, leaderRank);
+
+    std::vector<int> displs(counts.size(), 0);
+    std::partial_sum(counts.begin(), counts.end() - 1, displs.begin() + 1);
+
+    auto total = isLeader() ? static_cast<size_t>(displs.back() + counts.back()) : 0;
+
+    // Avoid handing out a null pointer on the non-root ranks
+    std::vector<char> gathered(std::max<size_t>(total, 1));
+
+    auto sbeg = static_cast<const char*>(msg.payload().data());
+    nodeComm_.gatherv(sbeg, sbeg + msg.size(), gathered.data(), gathered.data() + total, counts, displs, leaderRank);
+
+    gathered.resize(total);
+    return gathered;
+}
+
+Message NodeAggregation::gatherDomain(const Message& msg) const {
+    util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
+
+    std::vector<int> counts;
+    auto gathered = gatherPayload(msg, counts);
+
+    if (not isLeader()) {
+        return msg;
+    }
+
+    const auto representation = msg.metadata().getString("representation");
+    if (representation != "structured" && representation != "unstructured") {
+        throw eckit::UserError("Node aggregation does not support domain representation " + representation,
+                               Here());
+    }
+
+    NodeDomain nodeDomain;
+    std::vector<int32_t> nodeIndices;
+    long globalSize = 0;
+
+    auto it = reinterpret_cast<const int32_t*>(gathered.data());
+    for (const auto count : counts) {
+        std::vector<int32_t> def{it, it + count / sizeof(int32_t)};
+        it += count / sizeof(int32_t);
+
+        std::vector<int32_t> offsets;
+        if (representation == "unstructured") {
+            globalSize = msg.globalSize();
+            nodeDomain.dataSizes.push_back(static_cast<long>(def.size()));
+            nodeIndices.insert(nodeIndices.end(), def.begin(), def.end());
+        }
+        else {
+            ASSERT(def.size() == 11);
+
+            auto ni_global = def[0];
+            auto nj_global = def[1];
+            auto ibegin = def[2];
+            auto ni = def[3];
+            auto jbegin = def[4];
+            auto nj = def[5];
+            auto data_ibegin = def[7];
+            auto data_ni = def[8];
+            auto data_jbegin = def[9];
+            auto data_nj = def[10];
+
+            globalSize = static_cast<long>(ni_global) * nj_global;
+            nodeDomain.dataSizes.push_back(static_cast<long>(data_ni) * data_nj);
+
+            // Keep only the inner points, in the same order the server-side domain would scatter them
+            int32_t lidx = 0;
+            for (auto j = data_jbegin; j != data_jbegin + data_nj; ++j) {
+                for (auto i = data_ibegin; i != data_ibegin + data_ni; ++i, ++lidx) {
+                    if (inRange(i, 0, ni) && inRange(j, 0, nj)) {
+                        offsets.push_back(lidx);
+                        nodeIndices.push_back((jbegin + j) * ni_global + (ibegin + i));
+                    }
+                }
+            }
+
+            // No halo -- payload is copied as is
+            if (static_cast<long>(offsets.size()) == nodeDomain.dataSizes.back()) {
+                offsets.clear();
+            }
+        }
+        nodeDomain.offsets.push_back(std::move(offsets));
+    }
+
+    domains_[msg.name()] = std::move(nodeDomain);
+
+    LOG_DEBUG_LIB(LibMultio) << " *** Node-level domain " << msg.name() << " combines " << counts.size()
+                             << " partial domains into " << nodeIndices.size() << " points" << std::endl;
+
+    auto md = msg.metadata();
+    md.set("representation", std::string{"unstructured"});
+    md.set("globalSize", globalSize);
+
+    return Message{Message::Header{msg.tag(), Peer{msg.source()}, Peer{msg.destination()}, std::move(md)},
+                   eckit::Buffer{reinterpret_cast<const char*>(nodeIndices.data()),
+                                 nodeIndices.size() * sizeof(int32_t)}};
+}
+
+Message NodeAggregation::gatherPartial(const Message& msg) const {
+    util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
+
+    std::vector<int> counts;
+    auto gathered = gatherPayload(msg, counts);
+
+    if (not isLeader()) {
+        return msg;
+    }
+
+    auto dit = domains_.find(msg.domain());
+    if (dit == end(domains_)) {
+        throw eckit::SeriousBug("Node aggregation cannot find domain " + msg.domain(), Here());
+    }
+    const auto& nodeDomain = dit->second;
+    ASSERT(nodeDomain.dataSizes.size() == counts.size());
+
+    size_t nodeSize = 0;
+    for (size_t r = 0; r != counts.size(); ++r) {
+        auto elemSize = elementSize(counts[r], nodeDomain.dataSizes[r]);
+
+        // The node-level mask is applied to an unstructured domain on the server, which reads one byte per point
+        if (msg.tag() == Message::Tag::Mask && counts[r] != 0 && elemSize != 1) {
+            throw eckit::UserError("Node aggregation expects masks with one byte per point, mask " + msg.name()
+                                       + " has " + std::to_string(elemSize),
+                                   Here());
+        }
+
+        nodeSize += nodeDomain.offsets[r].empty() ? counts[r] : nodeDomain.offsets[r].size() * elemSize;
+    }
+
+    eckit::Buffer payload{nodeSize};
+
+    auto src = gathered.data();
+    auto dst = static_cast<char*>(payload.data());
+    for (size_t r = 0; r != counts.size(); ++r) {
+        const auto& offsets = nodeDomain.offsets[r];
+        if (offsets.empty()) {
+            std::memcpy(dst, src, counts[r]);
+            dst += counts[r];
+        }
+        else {
+            auto elemSize = elementSize(counts[r], nodeDomain.dataSizes[r]);
+            for (auto off : offsets) {
+                std::memcpy(dst, src + off * elemSize, elemSize);
+                dst += elemSize;
+            }
+        }
+        src += counts[r];
+    }
+
+    auto md = msg.metadata();
+    return Message{Message::Header{msg.tag(), Peer{msg.source()}, Peer{msg.destination()}, std::move(md)},
+                   std::move(payload)};
+}
+
+void NodeAggregation::print(std::ostream& os) const {
+    os << "NodeAggregation(rank " << nodeComm_.rank() << " of " << nodeComm_.size() << " on node, for "
+       << domains_.size() << " domains)";
+}
+
+
+static ActionBuilder<NodeAggregation> NodeAggregationBuilder("node-aggregation");
+
+}  // namespace action
+}  // namespace multio
@@ -0,0 +1,73 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2022
+
+/// Client-side, node-level pre-aggregation. All client ranks sharing a node gather their partial
+/// fields onto a node-leader rank, which forwards a single node-level partial field per field. The
+/// server-side aggregation then only sees one partial domain per node.
+///
+/// The action performs a collective operation on the node communicator for every domain, mask and
+/// field message. It therefore assumes, like the rest of the client-side API, that all client ranks
+/// write the same sequence of messages.
+
+#ifndef multio_server_actions_NodeAggregation_H
+#define multio_server_actions_NodeAggregation_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "multio/action/Action.h"
+
+namespace eckit {
+namespace mpi {
+class Comm;
+}
+}  // namespace eckit
+
+namespace multio {
+namespace action {
+
+using message::Message;
+
+class NodeAggregation : public Action {
+public:
+    explicit NodeAggregation(const ConfigurationContext& confCtx);
+
+    void executeImpl(Message msg) const override;
+
+private:
+    // Maps the partial field of every member rank onto the node-level (unstructured) domain
+    struct NodeDomain {
+        std::vector<long> dataSizes;                 // Number of points in each member's payload
+        std::vector<std::vector<int32_t>> offsets;  // Points of each member's payload kept on the node
+    };
+
+    void print(std::ostream& os) const override;
+
+    bool isLeader() const;
+
+    Message gatherDomain(const Message& msg) const;
+    Message gatherPartial(const Message& msg) const;
+
+    std::vector<char> gatherPayload(const Message& msg, std::vector<int>& counts) const;
+
+    const eckit::mpi::Comm& nodeComm_;
+
+    mutable std::map<std::string, NodeDomain> domains_;
+};
+
+}  // namespace action
+}  // namespace multio
+
+#endif
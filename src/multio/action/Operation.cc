@@ -4,22 +4,94 @@
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
 
+#include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
 
 #include "multio/LibMultio.h"
+#include "multio/util/Arena.h"
+#include "multio/util/MemoryAccount.h"
 
 namespace multio {
 namespace action {
 
+// Accumulators live as long as the server, so they are carved out of a few large chunks
+util::Arena& statisticsArena() {
+    static util::Arena arena{
+        eckit::Resource<size_t>("multioStatisticsArenaChunkSize;$MULTIO_STATISTICS_ARENA_CHUNK_SIZE",
+                                64 * 1024 * 1024),
+        eckit::Resource<bool>("multioStatisticsArenaHugePages;$MULTIO_STATISTICS_ARENA_HUGEPAGES", false)};
+    return arena;
+}
+
+template <typename T>
+T* allocateStatistics(long count) {
+    // Accounted first, so that exceeding the limit of the account does not grow the arena
+    auto& account = util::MemoryAccount::get("statistics");
+    account.add(count * sizeof(T));
+    try {
+        return statisticsArena().allocate<T>(count);
+    }
+    catch (...) {
+        account.remove(count * sizeof(T));
+        throw;
+    }
+}
+
+template <typename T>
+void releaseStatistics(T* ptr, long count) {
+    statisticsArena().deallocate(ptr, count);
+    util::MemoryAccount::get("statistics").remove(count * sizeof(T));
+}
+
+template double* allocateStatistics<double>(long);
+template float* allocateStatistics<float>(long);
+template void releaseStatistics<double>(double*, long);
+template void releaseStatistics<float>(float*, long);
+
 Operation::Operation(const std::string& name, long sz) :
-    name_{name}, values_{std::vector<double>(sz)} {}
+    name_{name}, size_{sz}, values_{allocateStatistics<double>(sz)} {
+    std::fill(values_, values_ + size_, 0.0);
+}
+
+Operation::~Operation() {
+    releaseStatistics(values_, size_);
+}
 
 const std::string& Operation::name() {
     return name_;
 }
 
+long Operation::size() const {
+    return size_;
+}
+
+namespace {
+template <typename Op>
+const Op& mergeable(const Operation& finer, long size) {
+    auto op = dynamic_cast<const Op*>(&finer);
+    if (op == nullptr) {
+        throw eckit::SeriousBug{"Cannot merge operations of different kinds", Here()};
+    }
+    ASSERT(op->size() == size);
+    return *op;
+}
+}  // namespace
+
+void Operation::reset() {
+    std::fill(values_, values_ + size_, 0.0);
+}
+
+long Operation::counter() const {
+    return 0;
+}
+
+void Operation::restore(const double* values, long) {
+    std::copy(values, values + size_, values_);
+}
+
 std::ostream& operator<<(std::ostream& os, const Operation& a) {
     a.print(os);
     return os;
@@ -29,21 +101,35 @@ std::ostream& operator<<(std::ostream& os, const Operation& a) {
 
 Instant::Instant(const std::string& name, long sz) : Operation{name, sz} {}
 
-const std::vector<double>& Instant::compute() {
+const double* Instant::compute() {
     return values_;
 }
 
-void Instant::update(const double* val, long sz) {
-    ASSERT(values_.size() == static_cast<size_t>(sz));
+template <typename T>
+void Instant::updateValues(const T* val, long sz) {
+    ASSERT(size_ == sz);
 
     // May never be needed -- just creates an unnecessarily copy
-    std::copy(val, val + sz, values_.begin());
+    std::copy(val, val + sz, values_);
     LOG_DEBUG_LIB(LibMultio) << " ======== " << *this
-                             << ": minimum: " << *std::min_element(begin(values_), end(values_))
-                             << ", maximum: " << *std::max_element(begin(values_), end(values_))
+                             << ": minimum: " << *std::min_element(values_, values_ + size_)
+                             << ", maximum: " << *std::max_element(values_, values_ + size_)
                              << std::endl;
 }
 
+void Instant::update(const double* val, long sz) {
+    updateValues(val, sz);
+}
+
+void Instant::update(const float* val, long sz) {
+    updateValues(val, sz);
+}
+
+void Instant::merge(const Operation& finer) {
+    const auto& op = mergeable<Instant>(finer, size_);
+    std::copy(op.values_, op.values_ + size_, values_);
+}
+
 void Instant::print(std::ostream& os) const {
     os << "Operation(instant)";
 }
@@ -52,91 +138,164 @@ void Instant::print(std::ostream& os) const {
 
 Average::Average(const std::string& name, long sz) : Operation{name, sz} {}
 
-const std::vector<double>& Average::compute() {
+const double* Average::compute() {
     // eckit::Log::info() << " Compute ======== division by " << count_ << std::endl;
-    for(auto& val : values_) {
-        val /= static_cast<double>(count_);
+    for (auto it = values_; it != values_ + size_; ++it) {
+        *it /= static_cast<double>(count_);
     }
     // eckit::Log::info() << " Compute ======== " << *this
-    //                    << ": minimum: " << *std::min_element(begin(values_), end(values_))
-    //                    << ", maximum: " << *std::max_element(begin(values_), end(values_))
+    //                    << ": minimum: " << *std::min_element(values_, values_ + size_)
+    //                    << ", maximum: " << *std::max_element(values_, values_ + size_)
     //                    << ", count: " << count_ << std::endl;
 
     return values_;
 }
 
-void Average::update(const double* val, long sz) {
-    if (values_.size() != static_cast<size_t>(sz)) {
-        throw eckit::AssertionFailed("Expected size: " + std::to_string(values_.size()) +
+template <typename T>
+void Average::updateValues(const T* val, long sz) {
+    if (size_ != sz) {
+        throw eckit::AssertionFailed("Expected size: " + std::to_string(size_) +
                                      " -- actual size: " + std::to_string(sz));
     }
 
     // eckit::Log::info() << " Before update ======== " << *this
-    //                    << ": minimum: " << *std::min_element(begin(values_), end(values_))
-    //                    << ", maximum: " << *std::max_element(begin(values_), end(values_))
+    //                    << ": minimum: " << *std::min_element(values_, values_ + size_)
+    //                    << ", maximum: " << *std::max_element(values_, values_ + size_)
     //                    << ", count: " << count_ << std::endl;
 
-    for (auto& v : values_) {
-        v += *val++;
+    for (auto it = values_; it != values_ + size_; ++it) {
+        *it += *val++;
     }
     ++count_;
 
     // eckit::Log::info() << " After update  ======== " << *this
-    //                    << ": minimum: " << *std::min_element(begin(values_), end(values_))
-    //                    << ", maximum: " << *std::max_element(begin(values_), end(values_))
+    //                    << ": minimum: " << *std::min_element(values_, values_ + size_)
+    //                    << ", maximum: " << *std::max_element(values_, values_ + size_)
     //                    << ", count: " << count_ << std::endl;
 }
 
+void Average::reset() {
+    Operation::reset();
+    count_ = 0;
+}
+
+long Average::counter() const {
+    return count_;
+}
+
+void Average::restore(const double* values, long counter) {
+    Operation::restore(values, counter);
+    count_ = counter;
+}
+
+void Average::update(const double* val, long sz) {
+    updateValues(val, sz);
+}
+
+void Average::update(const float* val, long sz) {
+    updateValues(val, sz);
+}
+
+void Average::merge(const Operation& finer) {
+    const auto& op = mergeable<Average>(finer, size_);
+    auto val = op.values_;
+    for (auto it = values_; it != values_ + size_; ++it) {
+        *it += *val++;
+    }
+    count_ += op.count_;
+}
+
 void Average::print(std::ostream& os) const {
     os << "Operation(average)";
 }
 
 //===============================================================================
 
-Minimum::Minimum(const std::string& name, long sz) : Operation{name, sz} {}
+Minimum::Minimum(const std::string& name, long sz) : Operation{name, sz} {
+    reset();
+}
+
+void Minimum::reset() {
+    // Any value, including that of a merged finer period, replaces the initial one
+    std::fill(values_, values_ + size_, std::numeric_limits<double>::max());
+}
 
-const std::vector<double>& Minimum::compute() {
+const double* Minimum::compute() {
     return values_;
 }
 
-void Minimum::update(const double* val, long sz) {
-    ASSERT(values_.size() == static_cast<size_t>(sz));
+template <typename T>
+void Minimum::updateValues(const T* val, long sz) {
+    ASSERT(size_ == sz);
 
-    for (auto& v : values_) {
-        v = (v > *val) ? *val : v;
+    for (auto it = values_; it != values_ + size_; ++it) {
+        *it = (*it > *val) ? *val : *it;
         ++val;
     }
     LOG_DEBUG_LIB(LibMultio) << " ======== " << *this
-                             << ": minimum: " << *std::min_element(begin(values_), end(values_))
-                             << ", maximum: " << *std::max_element(begin(values_), end(values_))
+                             << ": minimum: " << *std::min_element(values_, values_ + size_)
+                             << ", maximum: " << *std::max_element(values_, values_ + size_)
                              << std::endl;
 }
 
+void Minimum::update(const double* val, long sz) {
+    updateValues(val, sz);
+}
+
+void Minimum::update(const float* val, long sz) {
+    updateValues(val, sz);
+}
+
+void Minimum::merge(const Operation& finer) {
+    const auto& op = mergeable<Minimum>(finer, size_);
+    updateValues(op.values_, op.size_);
+}
+
 void Minimum::print(std::ostream& os) const {
     os << "Operation(minimum)";
 }
 
 //===============================================================================
 
-Maximum::Maximum(const std::string& name, long sz) : Operation{name, sz} {}
+Maximum::Maximum(const std::string& name, long sz) : Operation{name, sz} {
+    reset();
+}
+
+void Maximum::reset() {
+    std::fill(values_, values_ + size_, std::numeric_limits<double>::lowest());
+}
 
-const std::vector<double>& Maximum::compute() {
+const double* Maximum::compute() {
     return values_;
 }
 
-void Maximum::update(const double* val, long sz) {
-    ASSERT(values_.size() == static_cast<size_t>(sz));
+template <typename T>
+void Maximum::updateValues(const T* val, long sz) {
+    ASSERT(size_ == sz);
 
-    for (auto& v : values_) {
-        v = (v < *val) ? *val : v;
+    for (auto it = values_; it != values_ + size_; ++it) {
+        *it = (*it < *val) ? *val : *it;
         ++val;
     }
     LOG_DEBUG_LIB(LibMultio) << " ======== " << *this
-                             << ": minimum: " << *std::min_element(begin(values_), end(values_))
-                             << ", maximum: " << *std::max_element(begin(values_), end(values_))
+                             << ": minimum: " << *std::min_element(values_, values_ + size_)
+                             << ", maximum: " << *std::max_element(values_, values_ + size_)
                              << std::endl;
 }
 
+void Maximum::update(const double* val, long sz) {
+    updateValues(val, sz);
+}
+
+void Maximum::update(const float* val, long sz) {
+    updateValues(val, sz);
+}
+
+void Maximum::merge(const Operation& finer) {
+    const auto& op = mergeable<Maximum>(finer, size_);
+    updateValues(op.values_, op.size_);
+}
+
 void Maximum::print(std::ostream& os) const {
     os << "Operation(maximum)";
 }
@@ -145,22 +304,36 @@ void Maximum::print(std::ostream& os) const {
 
 Accumulate::Accumulate(const std::string& name, long sz) : Operation{name, sz} {}
 
-const std::vector<double>& Accumulate::compute() {
+const double* Accumulate::compute() {
     return values_;
 }
 
-void Accumulate::update(const double* val, long sz) {
-    ASSERT(values_.size() == static_cast<size_t>(sz));
+template <typename T>
+void Accumulate::updateValues(const T* val, long sz) {
+    ASSERT(size_ == sz);
 
-    for (auto& v : values_) {
-        v += *val++;
+    for (auto it = values_; it != values_ + size_; ++it) {
+        *it += *val++;
     }
     LOG_DEBUG_LIB(LibMultio) << " ======== " << *this
-                             << ": minimum: " << *std::min_element(begin(values_), end(values_))
-                             << ", maximum: " << *std::max_element(begin(values_), end(values_))
+                             << ": minimum: " << *std::min_element(values_, values_ + size_)
+                             << ", maximum: " << *std::max_element(values_, values_ + size_)
                              << std::endl;
 }
 
+void Accumulate::update(const double* val, long sz) {
+    updateValues(val, sz);
+}
+
+void Accumulate::update(const float* val, long sz) {
+    updateValues(val, sz);
+}
+
+void Accumulate::merge(const Operation& finer) {
+    const auto& op = mergeable<Accumulate>(finer, size_);
+    updateValues(op.values_, op.size_);
+}
+
 void Accumulate::print(std::ostream& os) const {
     os << "Operation(accumulate)";
 }
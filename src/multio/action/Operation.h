@@ -1,11 +1,17 @@
 #ifndef multio_server_actions_Operation_H
 #define multio_server_actions_Operation_H
 
+#include <iosfwd>
 #include <memory>
 #include <string>
 #include <vector>
 
 namespace multio {
+
+namespace util {
+class Arena;
+}
+
 namespace action {
 
 //==== Base class =================================
@@ -15,16 +21,36 @@ public:
     Operation(const std::string& name, long sz);
     const std::string& name();
 
-    virtual const std::vector<double>& compute() = 0;
+    long size() const;
+
+    // Result is a view onto the accumulator, valid until the next update or reset
+    virtual const double* compute() = 0;
     virtual void update(const double* val, long sz) = 0;
+    virtual void update(const float* val, long sz) = 0;
+
+    // Fold in the state of the same operation over a finer, contained period. Must be called before
+    // the finer operation is computed.
+    virtual void merge(const Operation& finer) = 0;
+
+    // Return to the initial state without reallocating
+    virtual void reset();
+
+    // Raw state, for snapshots
+    const double* values() const { return values_; }
+    virtual long counter() const;
+    virtual void restore(const double* values, long counter);
+
+    Operation(const Operation&) = delete;
+    Operation& operator=(const Operation&) = delete;
 
-    virtual ~Operation() = default;
+    virtual ~Operation();
 
 protected:
     virtual void print(std::ostream& os) const = 0;
 
     std::string name_;
-    std::vector<double> values_;
+    long size_;
+    double* values_;  // Allocated from the statistics arena
 
     friend std::ostream& operator<<(std::ostream& os, const Operation& a);
 };
@@ -35,11 +61,17 @@ class Instant final : public Operation {
 public:
     Instant(const std::string& name, long sz = 0);
 
-    const std::vector<double>& compute() override;
+    const double* compute() override;
 
     void update(const double* val, long sz) override;
+    void update(const float* val, long sz) override;
+
+    void merge(const Operation& finer) override;
 
 private:
+    template <typename T>
+    void updateValues(const T* val, long sz);
+
     void print(std::ostream &os) const override;
 };
 
@@ -49,11 +81,22 @@ class Average final : public Operation {
 public:
     Average(const std::string& name, long sz = 0);
 
-    const std::vector<double>& compute() override;
+    const double* compute() override;
+
+    void reset() override;
+
+    long counter() const override;
+    void restore(const double* values, long counter) override;
 
     void update(const double* val, long sz) override;
+    void update(const float* val, long sz) override;
+
+    void merge(const Operation& finer) override;
 
 private:
+    template <typename T>
+    void updateValues(const T* val, long sz);
+
     void print(std::ostream &os) const override;
 };
 
@@ -61,11 +104,19 @@ class Minimum final : public Operation {
 public:
     Minimum(const std::string& name, long sz = 0);
 
-    const std::vector<double>& compute() override;
+    const double* compute() override;
 
     void update(const double* val, long sz) override;
+    void update(const float* val, long sz) override;
+
+    void merge(const Operation& finer) override;
+
+    void reset() override;
 
 private:
+    template <typename T>
+    void updateValues(const T* val, long sz);
+
     void print(std::ostream &os) const override;
 };
 
@@ -73,11 +124,19 @@ class Maximum final : public Operation {
 public:
     Maximum(const std::string& name, long sz = 0);
 
-    const std::vector<double>& compute() override;
+    const double* compute() override;
 
     void update(const double* val, long sz) override;
+    void update(const float* val, long sz) override;
+
+    void merge(const Operation& finer) override;
+
+    void reset() override;
 
 private:
+    template <typename T>
+    void updateValues(const T* val, long sz);
+
     void print(std::ostream &os) const override;
 };
 
@@ -85,11 +144,17 @@ class Accumulate final : public Operation {
 public:
     Accumulate(const std::string& name, long sz = 0);
 
-    const std::vector<double>& compute() override;
+    const double* compute() override;
 
     void update(const double* val, long sz) override;
+    void update(const float* val, long sz) override;
+
+    void merge(const Operation& finer) override;
 
 private:
+    template <typename T>
+    void updateValues(const T* val, long sz);
+
     void print(std::ostream &os) const override;
 };
 
@@ -97,6 +162,18 @@ private:
 
 std::unique_ptr<Operation> make_operation(const std::string& opname, long sz);
 
+//==== Accumulator storage =========================
+
+// Shared by the statistics of all actions on the server
+util::Arena& statisticsArena();
+
+// Blocks of the statistics arena, accounted as "statistics". Released blocks are reused for the same size.
+template <typename T>
+T* allocateStatistics(long count);
+
+template <typename T>
+void releaseStatistics(T* ptr, long count);
+
 }  // namespace action
 }  // namespace multio
 
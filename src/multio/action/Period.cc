@@ -61,6 +61,10 @@ bool DateTimePeriod::isWithin(const eckit::DateTime& dt) {
     return ret;
 }
 
+eckit::DateTime DateTimePeriod::startPoint() const {
+    return startPoint_;
+}
+
 eckit::DateTime DateTimePeriod::endPoint() const {
     return endPoint_;
 }
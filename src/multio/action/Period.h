@@ -35,6 +35,7 @@ public:
 
     bool isWithin(const eckit::DateTime& dt);
 
+    eckit::DateTime startPoint() const;
     eckit::DateTime endPoint() const;
 
 private:
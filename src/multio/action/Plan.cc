@@ -41,6 +41,8 @@ LocalConfiguration createActionList(std::vector<LocalConfiguration> actions) {
     return current;
 }
 
+}  // namespace
+
 LocalConfiguration rootConfig(const LocalConfiguration& config) {
     const auto actions =
         config.has("actions") ? config.getSubConfigurations("actions") : std::vector<LocalConfiguration>{};
@@ -52,8 +54,6 @@ LocalConfiguration rootConfig(const LocalConfiguration& config) {
     return createActionList(actions);
 }
 
-}  // namespace
-
 Plan::Plan(const ConfigurationContext& confCtx) : FailureAware(confCtx) {
     ASSERT(confCtx.componentTag() == util::ComponentTag::Plan);
     name_ = confCtx.config().getString("name", "anonymous");
@@ -69,13 +69,25 @@ Plan::~Plan() {
 
 void Plan::process(message::Message msg) {
     util::ScopedTimer timer{timing_};
-    withFailureHandling([&]() { root_->execute(std::move(msg)); }, [=]() {
+    const auto described = msg.withoutPayload();
+    withFailureHandling([&]() { root_->execute(std::move(msg)); }, [&]() {
         std::ostringstream oss;
-        oss << "Plan \"" << name_ << "\" with Message: " << msg << std::endl; 
+        oss << "Plan \"" << name_ << "\" with Message: " << described << std::endl; 
         return oss.str();
     });
 }
 
+void Plan::process(const std::vector<message::Message>& msgs) {
+    util::ScopedTimer timer{timing_};
+    for (const auto& msg : msgs) {
+        withFailureHandling([&]() { root_->execute(msg); }, [&]() {
+            std::ostringstream oss;
+            oss << "Plan \"" << name_ << "\" with Message: " << msg << " (batch of " << msgs.size() << ")" << std::endl;
+            return oss.str();
+        });
+    }
+}
+
 util::FailureHandlerResponse Plan::handleFailure(util::OnPlanError t, const util::FailureContext&, util::DefaultFailureState&) const {
     if (t == util::OnPlanError::Recover) {
         return util::FailureHandlerResponse::Retry;
@@ -84,6 +96,10 @@ util::FailureHandlerResponse Plan::handleFailure(util::OnPlanError t, const util
 };
 
 
+bool Plan::selection(std::string& key, std::vector<std::string>& items) const {
+    return root_->selection(key, items);
+}
+
 void Plan::computeActiveFields(std::insert_iterator<std::set<std::string>>& ins) const {
     root_->computeActiveFields(ins);
 };
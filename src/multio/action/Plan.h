@@ -18,6 +18,7 @@
 #define multio_server_Plan_H
 
 #include <memory>
+#include <vector>
 
 #include "eckit/log/Statistics.h"
 #include "eckit/memory/NonCopyable.h"
@@ -35,16 +36,23 @@ using util::FailureAware;
 
 class Action;
 
+// Chains the list of `actions` in the configuration, returning the configuration of the first one
+eckit::LocalConfiguration rootConfig(const eckit::LocalConfiguration& config);
+
 class Plan : private eckit::NonCopyable, public FailureAware<util::ComponentTag::Plan> {
 public:
     Plan(const ConfigurationContext& confCtx);
     virtual ~Plan();
 
     virtual void process(message::Message msg);
+    virtual void process(const std::vector<message::Message>& msgs);
 
     void computeActiveFields(std::insert_iterator<std::set<std::string>>& ins) const;
     void computeActiveCategories(std::insert_iterator<std::set<std::string>>& ins) const;
 
+    // Selection applied by the first action of the plan, if any
+    bool selection(std::string& key, std::vector<std::string>& items) const;
+
     util::FailureHandlerResponse handleFailure(util::OnPlanError, const util::FailureContext&, util::DefaultFailureState&) const override;
 
 protected:
@@ -0,0 +1,75 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "Router.h"
+
+#include <algorithm>
+
+#include "multio/LibMultio.h"
+#include "multio/action/Plan.h"
+#include "multio/message/Metadata.h"
+
+namespace multio {
+namespace action {
+
+Router::Router(const std::vector<std::unique_ptr<Plan>>& plans) {
+    for (const auto& plan : plans) {
+        allPlans_.push_back(plan.get());
+
+        Selection sel;
+        sel.routed = plan->selection(sel.key, sel.items);
+        if (sel.routed && std::find(keys_.begin(), keys_.end(), sel.key) == keys_.end()) {
+            keys_.push_back(sel.key);
+        }
+        selections_.push_back(std::move(sel));
+    }
+
+    LOG_DEBUG_LIB(LibMultio) << " *** Routing " << plans.size() << " plans on " << keys_.size() << " metadata keys"
+                             << std::endl;
+}
+
+const std::vector<Plan*>& Router::route(const message::Message& msg) const {
+    if (keys_.empty()) {
+        return allPlans_;
+    }
+
+    const auto& md = msg.metadata();
+
+    std::string routeKey;
+    for (const auto& key : keys_) {
+        // Leave it to the plans to deal with incomplete metadata
+        if (not md.has(key)) {
+            return allPlans_;
+        }
+        routeKey += message::to_string(md, key);
+        routeKey += '\0';
+    }
+
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    auto it = routes_.find(routeKey);
+    if (it != routes_.end()) {
+        return it->second;
+    }
+
+    std::vector<Plan*> route;
+    for (size_t ii = 0; ii != allPlans_.size(); ++ii) {
+        const auto& sel = selections_[ii];
+        if (not sel.routed
+            || std::find(sel.items.begin(), sel.items.end(), message::to_string(md, sel.key)) != sel.items.end()) {
+            route.push_back(allPlans_[ii]);
+        }
+    }
+
+    return routes_.emplace(std::move(routeKey), std::move(route)).first->second;
+}
+
+}  // namespace action
+}  // namespace multio
@@ -0,0 +1,62 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2022
+
+/// Routing table from message metadata to the plans that may accept a message. It is built from the
+/// selection at the head of each plan; plans not starting with a selection receive every message. The
+/// plans a message is routed to still apply their own selection, so the table only has to be
+/// conservative.
+
+#ifndef multio_action_Router_H
+#define multio_action_Router_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "multio/message/Message.h"
+
+namespace multio {
+namespace action {
+
+class Plan;
+
+class Router {
+public:
+    explicit Router(const std::vector<std::unique_ptr<Plan>>& plans);
+
+    // Plans, in configuration order, that may accept the message
+    const std::vector<Plan*>& route(const message::Message& msg) const;
+
+private:
+    struct Selection {
+        bool routed;
+        std::string key;
+        std::vector<std::string> items;
+    };
+
+    std::vector<Plan*> allPlans_;
+    std::vector<Selection> selections_;  // One per plan
+
+    // Metadata keys that the routing depends on
+    std::vector<std::string> keys_;
+
+    // Resolved routes, indexed by the values of keys_
+    mutable std::unordered_map<std::string, std::vector<Plan*>> routes_;
+    mutable std::mutex mutex_;
+};
+
+}  // namespace action
+}  // namespace multio
+
+#endif
@@ -13,8 +13,10 @@
 #include <algorithm>
 
 #include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
 
 #include "multio/LibMultio.h"
+#include "multio/message/Metadata.h"
 #include "multio/util/ScopedTimer.h"
 
 namespace multio {
@@ -27,19 +29,117 @@ const std::map<std::string, std::string> plural = {{"category", "categories"}, {
 
 const std::map<std::string, std::string> mdEntry = {{"category", "category"}, {"field", "name"}};
 
-std::vector<std::string> fetch_items(const std::string& match, const eckit::Configuration& config) {
-    return config.getStringVector(plural.at(match));
+template <typename Predicate>
+Predicate& predicateFor(std::vector<Predicate>& predicates, const std::string& key, bool numeric) {
+    auto it = std::find_if(begin(predicates), end(predicates), [&key](const Predicate& p) { return p.key == key; });
+    if (it == end(predicates)) {
+        predicates.emplace_back();
+        predicates.back().key = key;
+        predicates.back().numeric = numeric;
+        return predicates.back();
+    }
+    if (it->numeric != numeric) {
+        throw eckit::UserError{"Select cannot combine value lists and ranges on key " + key, Here()};
+    }
+    return *it;
+}
+
+// Legacy form -- match : category|field, with the list of categories or fields
+template <typename Predicate>
+void compileMatch(const eckit::Configuration& config, std::vector<Predicate>& predicates) {
+    const auto match = config.getString("match");
+    if (std::none_of(begin(matchTypes), end(matchTypes), [&match](const std::string& mt) { return match == mt; })) {
+        throw eckit::SeriousBug{"Cannot match " + match};
+    }
+
+    auto& pred = predicateFor(predicates, mdEntry.at(match), false);
+    pred.listed = true;
+    pred.items = message::to_string_vector(config, plural.at(match));
+    pred.included.insert(begin(pred.items), end(pred.items));
+}
+
+// Conjunction of conditions, each on one metadata key, given by `in`, `not-in`, `min` and/or `max`
+template <typename Predicate>
+void compileConditions(const eckit::Configuration& config, std::vector<Predicate>& predicates) {
+    for (const auto& cond : config.getSubConfigurations("conditions")) {
+        const auto key = cond.getString("key");
+
+        if (cond.has("in") || cond.has("not-in")) {
+            auto& pred = predicateFor(predicates, key, false);
+            if (cond.has("in")) {
+                auto items = message::to_string_vector(cond, "in");
+                if (not pred.listed) {
+                    pred.listed = true;
+                    pred.items = items;
+                    pred.included.insert(begin(items), end(items));
+                }
+                else {
+                    // Several lists on the same key -- keep their intersection
+                    std::unordered_set<std::string> both;
+                    std::vector<std::string> bothItems;
+                    for (const auto& item : items) {
+                        if (pred.included.count(item) != 0 && both.insert(item).second) {
+                            bothItems.push_back(item);
+                        }
+                    }
+                    pred.included = std::move(both);
+                    pred.items = std::move(bothItems);
+                    if (pred.included.empty()) {
+                        eckit::Log::warning() << "Select conditions on " << key << " can never be met" << std::endl;
+                    }
+                }
+            }
+            if (cond.has("not-in")) {
+                for (const auto& item : message::to_string_vector(cond, "not-in")) {
+                    pred.excluded.insert(item);
+                }
+            }
+        }
+
+        if (cond.has("min") || cond.has("max")) {
+            auto& pred = predicateFor(predicates, key, true);
+            if (cond.has("min")) {
+                pred.minimum = std::max(pred.minimum, cond.getLong("min"));
+            }
+            if (cond.has("max")) {
+                pred.maximum = std::min(pred.maximum, cond.getLong("max"));
+            }
+        }
+    }
 }
 }  // namespace
 
-Select::Select(const ConfigurationContext& confCtx) :
-    Action{confCtx},
-    match_{confCtx.config().getString("match")},
-    items_{fetch_items(match_, confCtx.config())} {
-    if (std::none_of(begin(matchTypes), end(matchTypes),
-                     [this](const std::string& mt) { return match_ == mt; })) {
-        throw eckit::SeriousBug{"Cannot match " + match_};
+bool Select::Predicate::matches(const message::Metadata& md) const {
+    if (not md.has(key)) {
+        return false;
+    }
+
+    if (numeric) {
+        auto value = md.getLong(key);
+        return minimum <= value && value <= maximum;
+    }
+
+    // Metadata such as level or paramId are integers, compared by their decimal representation
+    auto value = message::to_string(md, key);
+    return (not listed || included.count(value) != 0) && excluded.count(value) == 0;
+}
+
+Select::Select(const ConfigurationContext& confCtx) : Action{confCtx} {
+    const auto& config = confCtx.config();
+    if (config.has("match")) {
+        compileMatch(config, predicates_);
     }
+    if (config.has("conditions")) {
+        compileConditions(config, predicates_);
+    }
+    if (predicates_.empty()) {
+        throw eckit::UserError{"Select requires either 'match' or 'conditions'", Here()};
+    }
+
+    // Cheapest and most selective checks first
+    std::stable_sort(begin(predicates_), end(predicates_), [](const Predicate& lhs, const Predicate& rhs) {
+        return lhs.listed && not rhs.listed;
+    });
 }
 
 void Select::executeImpl(Message msg) const {
@@ -48,38 +148,79 @@ void Select::executeImpl(Message msg) const {
     }
 }
 
+const Select::Predicate* Select::find(const std::string& key) const {
+    for (const auto& pred : predicates_) {
+        if (pred.key == key && pred.listed) {
+            return &pred;
+        }
+    }
+    return nullptr;
+}
+
 void Select::activeFields(std::insert_iterator<std::set<std::string>>& ins) const {
-    if (match_ == "field") {
-        std::copy(items_.begin(), items_.end(), ins);
+    if (auto pred = find(mdEntry.at("field"))) {
+        std::copy(pred->items.begin(), pred->items.end(), ins);
     }
 }
 void Select::activeCategories(std::insert_iterator<std::set<std::string>>& ins) const {
-    if (match_ == "category") {
-        std::copy(items_.begin(), items_.end(), ins);
+    if (auto pred = find(mdEntry.at("category"))) {
+        std::copy(pred->items.begin(), pred->items.end(), ins);
     }
 }
 
+bool Select::selection(std::string& key, std::vector<std::string>& items) const {
+    for (const auto& pred : predicates_) {
+        if (pred.listed) {
+            key = pred.key;
+            items = pred.items;
+            return true;
+        }
+    }
+    return false;
+}
 
 bool Select::matchPlan(const Message& msg) const {
     util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
-    auto item = msg.metadata().getString(mdEntry.at(match_));
-
-    LOG_DEBUG_LIB(LibMultio) << " *** Item " << item << " is being matched... ";
 
-    bool ret = find(begin(items_), end(items_), item) != end(items_);
+    const auto& md = msg.metadata();
+    bool ret = std::all_of(begin(predicates_), end(predicates_),
+                           [&md](const Predicate& pred) { return pred.matches(md); });
 
-    LOG_DEBUG_LIB(LibMultio) << (ret ? "found" : "not found") << std::endl;
+    LOG_DEBUG_LIB(LibMultio) << " *** Message " << msg.fieldId() << (ret ? " selected" : " not selected")
+                             << std::endl;
 
     return ret;
 }
 
 void Select::print(std::ostream& os) const {
-    os << "Select(" << plural.at(match_) << "=(";
+    os << "Select(";
     bool first = true;
-    for (const auto& cat : items_) {
+    for (const auto& pred : predicates_) {
         os << (first ? "" : ", ");
-        os << cat;
         first = false;
+        if (pred.numeric) {
+            os << pred.minimum << " <= " << pred.key << " <= " << pred.maximum;
+            continue;
+        }
+        os << pred.key;
+        if (pred.listed) {
+            os << " in (";
+            auto sep = "";
+            for (const auto& item : pred.items) {
+                os << sep << item;
+                sep = ", ";
+            }
+            os << ")";
+        }
+        if (not pred.excluded.empty()) {
+            os << " not in (";
+            auto sep = "";
+            for (const auto& item : pred.excluded) {
+                os << sep << item;
+                sep = ", ";
+            }
+            os << ")";
+        }
     }
     os << ")";
 }
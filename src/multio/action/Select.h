@@ -18,9 +18,12 @@
 #define multio_server_actions_Select_H
 
 #include <iosfwd>
-#include <vector>
-#include <set>
 #include <iterator>
+#include <limits>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "multio/action/Action.h"
 
@@ -35,17 +38,37 @@ public:
 
     void executeImpl(Message msg) const override;
 
+    // Only fields and categories listed with `match` or `in` are reported as active. A select that restricts
+    // names or categories by `not-in` or a range alone reports none.
     void activeFields(std::insert_iterator<std::set<std::string>>& ins) const override;
     void activeCategories(std::insert_iterator<std::set<std::string>>& ins) const override;
 
+    bool selection(std::string& key, std::vector<std::string>& items) const override;
+
 private:
+    // All conditions on one metadata key, evaluated with a single lookup
+    struct Predicate {
+        std::string key;
+        bool numeric = false;
+
+        bool listed = false;             // Whether the value must be one of `items`
+        std::vector<std::string> items;  // Keeps the configured order, for printing and routing
+        std::unordered_set<std::string> included;
+        std::unordered_set<std::string> excluded;
+
+        long minimum = std::numeric_limits<long>::min();
+        long maximum = std::numeric_limits<long>::max();
+
+        bool matches(const message::Metadata& md) const;
+    };
+
     void print(std::ostream &os) const override;
 
     bool matchPlan(const Message& msg) const;
 
-    std::string match_;
-    std::vector<std::string> items_;
+    const Predicate* find(const std::string& key) const;
 
+    std::vector<Predicate> predicates_;
 };
 
 }  // namespace action
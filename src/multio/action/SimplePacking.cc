@@ -0,0 +1,211 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "SimplePacking.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace multio {
+namespace action {
+
+namespace {
+
+const long maxBinaryScale = 127;
+const long maxBitsPerValue = 32;
+const size_t scanLanes = 4;
+const size_t packBlock = 256;
+
+// n^s by repeated multiplication, exactly as ecCodes computes its powers
+double power(long s, long n) {
+    double result = 1.0;
+    if (s == 0) {
+        return result;
+    }
+    if (s == 1) {
+        return n;
+    }
+    while (s < 0) {
+        result /= n;
+        ++s;
+    }
+    while (s > 0) {
+        result *= n;
+        --s;
+    }
+    return result;
+}
+
+// Largest single-precision number not greater than x
+double nearestSmallerFloat(double x) {
+    auto f = static_cast<float>(x);
+    if (static_cast<double>(f) > x) {
+        f = std::nextafter(f, -std::numeric_limits<float>::infinity());
+    }
+    return f;
+}
+
+// Smallest binary scale at which the range still fits into the bits per value. Returns false on underflow.
+bool binaryScaleFactor(double max, double min, long bitsPerValue, long& scale) {
+    const double range = max - min;
+    const double dmaxint = power(bitsPerValue, 2) - 1;
+    const auto maxint = static_cast<unsigned long>(dmaxint);
+
+    double zs = 1;
+    scale = 0;
+
+    while ((range * zs) <= dmaxint) {
+        --scale;
+        zs *= 2;
+    }
+    while ((range * zs) > dmaxint) {
+        ++scale;
+        zs /= 2;
+    }
+    while (static_cast<unsigned long>(range * zs + 0.5) <= maxint) {
+        --scale;
+        zs *= 2;
+    }
+    while (static_cast<unsigned long>(range * zs + 0.5) > maxint) {
+        ++scale;
+        zs /= 2;
+    }
+
+    return scale >= -maxBinaryScale && scale <= maxBinaryScale;
+}
+
+}  // namespace
+
+size_t SimplePacking::packedSize(size_t count) const {
+    return (count * static_cast<size_t>(bitsPerValue) + 7) / 8;
+}
+
+uint32_t SimplePacking::referenceBits() const {
+    const auto f = static_cast<float>(referenceValue);
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+bool computeSimplePacking(const double* values, size_t count, long bitsPerValue, SimplePacking& packing) {
+    if (count == 0 || bitsPerValue < 1 || bitsPerValue > maxBitsPerValue) {
+        return false;
+    }
+
+    // Independent lanes without branches, for the compiler to vectorise. The difference of a value with
+    // itself is non-zero only for infinities and NaNs.
+    double lo[scanLanes];
+    double hi[scanLanes];
+    double nonFinite[scanLanes];
+    for (size_t l = 0; l != scanLanes; ++l) {
+        lo[l] = hi[l] = values[0];
+        nonFinite[l] = 0.0;
+    }
+
+    size_t i = 0;
+    for (; i + scanLanes <= count; i += scanLanes) {
+        for (size_t l = 0; l != scanLanes; ++l) {
+            const double v = values[i + l];
+            lo[l] = v < lo[l] ? v : lo[l];
+            hi[l] = v > hi[l] ? v : hi[l];
+            nonFinite[l] += v - v;
+        }
+    }
+    for (; i != count; ++i) {
+        const double v = values[i];
+        lo[0] = v < lo[0] ? v : lo[0];
+        hi[0] = v > hi[0] ? v : hi[0];
+        nonFinite[0] += v - v;
+    }
+
+    double min = lo[0];
+    double max = hi[0];
+    for (size_t l = 0; l != scanLanes; ++l) {
+        if (!(nonFinite[l] == 0.0)) {
+            return false;
+        }
+        min = std::min(min, lo[l]);
+        max = std::max(max, hi[l]);
+    }
+
+    // Constant fields are not packed at all
+    if (min == max) {
+        return false;
+    }
+
+    // The reference value must be a normal single-precision number
+    if (std::fabs(min) > FLT_MAX || std::fabs(max) > FLT_MAX || (min != 0.0 && std::fabs(min) < FLT_MIN)) {
+        return false;
+    }
+
+    // ecCodes would adjust the decimal scale factor to bring the range within reach of the binary scale
+    const double f = power(bitsPerValue, 2) - 1;
+    const double range = max - min;
+    if (range < power(-maxBinaryScale, 2) * f || range > power(maxBinaryScale, 2) * f) {
+        return false;
+    }
+
+    packing.referenceValue = nearestSmallerFloat(min);
+    packing.decimalScaleFactor = 0;
+    packing.bitsPerValue = bitsPerValue;
+
+    return binaryScaleFactor(max, packing.referenceValue, bitsPerValue, packing.binaryScaleFactor);
+}
+
+void packSimple(const double* values, size_t count, const SimplePacking& packing, unsigned char* out) {
+    const double reference = packing.referenceValue;
+    const double divisor = power(-packing.binaryScaleFactor, 2);
+    const auto bits = static_cast<unsigned>(packing.bitsPerValue);
+    const uint64_t mask = (uint64_t(1) << bits) - 1;
+
+    // Quantise a block at a time in a loop that vectorises, then pack its bits. Without decimal scaling and
+    // with a power of two as divisor, the rounding is the same as that of ecCodes, whether or not the
+    // compiler contracts the expression. The quantised values are non-negative and fit into the bits per
+    // value, so converting through a signed 32-bit integer, which vectorises more widely, truncates the same.
+    uint32_t quantised[packBlock];
+
+    uint64_t acc = 0;
+    unsigned pending = 0;
+    for (size_t start = 0; start < count; start += packBlock) {
+        const size_t n = std::min(packBlock, count - start);
+        const double* block = values + start;
+
+        if (bits < 32) {
+            for (size_t i = 0; i != n; ++i) {
+                quantised[i] = static_cast<uint32_t>(static_cast<int32_t>(((block[i] - reference) * divisor) + 0.5));
+            }
+        }
+        else {
+            for (size_t i = 0; i != n; ++i) {
+                quantised[i] = static_cast<uint32_t>(static_cast<uint64_t>(((block[i] - reference) * divisor) + 0.5));
+            }
+        }
+
+        for (size_t i = 0; i != n; ++i) {
+            acc = (acc << bits) | (quantised[i] & mask);
+            pending += bits;
+            while (pending >= 8) {
+                pending -= 8;
+                *out++ = static_cast<unsigned char>(acc >> pending);
+            }
+        }
+    }
+
+    // The last byte is padded with zero bits
+    if (pending > 0) {
+        *out = static_cast<unsigned char>(acc << (8 - pending));
+    }
+}
+
+}  // namespace action
+}  // namespace multio
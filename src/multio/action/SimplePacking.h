@@ -0,0 +1,52 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Nov 2022
+
+/// Native GRIB2 simple packing (data representation template 5.0), as an alternative to having ecCodes
+/// pack the values. It follows the algorithm of ecCodes for a given number of bits per value, without
+/// decimal scaling, and produces the same reference value, binary scale factor and packed bits.
+///
+/// Only the fields for which the result is guaranteed to agree with ecCodes are taken on. Everything
+/// else -- constant fields, non-finite values, values outside the range of the reference value or
+/// ranges that would need decimal scaling -- is left to ecCodes.
+
+#ifndef multio_server_actions_SimplePacking_H
+#define multio_server_actions_SimplePacking_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace multio {
+namespace action {
+
+struct SimplePacking {
+    double referenceValue = 0.0;
+    long binaryScaleFactor = 0;
+    long decimalScaleFactor = 0;
+    long bitsPerValue = 0;
+
+    // Size of the packed values in bytes, i.e. of the data section without its header
+    size_t packedSize(size_t count) const;
+
+    // Reference value as it is encoded, an IEEE single-precision number
+    uint32_t referenceBits() const;
+};
+
+// Determines the packing parameters for the values. Returns false for fields left to ecCodes.
+bool computeSimplePacking(const double* values, size_t count, long bitsPerValue, SimplePacking& packing);
+
+// Writes the packed values, packing.packedSize(count) bytes
+void packSimple(const double* values, size_t count, const SimplePacking& packing, unsigned char* out);
+
+}  // namespace action
+}  // namespace multio
+
+#endif
@@ -10,22 +10,182 @@
 
 #include "Sink.h"
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
 
+#include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/message/Message.h"
 
 #include "multio/LibMultio.h"
+#include "multio/util/MemoryAccount.h"
+#include "multio/util/Metrics.h"
 #include "multio/util/logfile_name.h"
 #include "multio/util/ScopedTimer.h"
 
 namespace multio {
 namespace action {
 
+// Runs the sink operations in the order they were queued, on a thread of its own. A step counts as
+// unflushed from the moment its flush is queued until that flush has returned.
+class Sink::AsyncFlush {
+public:
+    AsyncFlush(size_t maxUnflushedSteps, size_t queueSize) :
+        maxUnflushedSteps_{maxUnflushedSteps},
+        queueSize_{queueSize},
+        account_{util::MemoryAccount::get("sink-queue")},
+        unflushedGauge_{util::Metrics::instance().gauge("sink_unflushed_steps")},
+        thread_{[this]() { run(); }} {
+        ASSERT(queueSize_ > 0);
+    }
+
+    ~AsyncFlush() {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            closed_ = true;
+        }
+        notEmpty_.notify_all();
+        thread_.join();
+    }
+
+    void push(std::function<void()> job, size_t bytes = 0, bool stepEnd = false) {
+        std::unique_lock<std::mutex> lock{mutex_};
+        rethrow();
+        changed_.wait(lock, [this]() { return jobs_.size() < queueSize_; });
+
+        account_.add(bytes);
+        if (stepEnd) {
+            ++unflushed_;
+            unflushedGauge_.add(1);
+        }
+        jobs_.push_back(Job{std::move(job), bytes, stepEnd});
+
+        lock.unlock();
+        notEmpty_.notify_one();
+    }
+
+    // Blocks while more steps than allowed are still being made durable
+    void throttle() {
+        std::unique_lock<std::mutex> lock{mutex_};
+        changed_.wait(lock, [this]() { return unflushed_ <= maxUnflushedSteps_; });
+        rethrow();
+    }
+
+    // Time spent running the operations, to be read once drained
+    const eckit::Timing& timing() const { return timing_; }
+
+    // Blocks until every queued operation has completed
+    void drain() {
+        std::unique_lock<std::mutex> lock{mutex_};
+        changed_.wait(lock, [this]() { return jobs_.empty() && not busy_; });
+        rethrow();
+    }
+
+private:
+    struct Job {
+        std::function<void()> run;
+        size_t bytes;
+        bool stepEnd;
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> lock{mutex_};
+        while (true) {
+            notEmpty_.wait(lock, [this]() { return closed_ || not jobs_.empty(); });
+            if (jobs_.empty()) {
+                return;
+            }
+
+            auto job = std::move(jobs_.front());
+            jobs_.pop_front();
+            busy_ = true;
+
+            // Operations behind a failed one are dropped until the failure has been reported
+            if (not error_) {
+                lock.unlock();
+                try {
+                    util::ScopedTiming timing{timer_, timing_};
+                    job.run();
+                }
+                catch (...) {
+                    lock.lock();
+                    error_ = std::current_exception();
+                    lock.unlock();
+                }
+                // Release the payload outside the lock
+                job.run = nullptr;
+                lock.lock();
+            }
+
+            account_.remove(job.bytes);
+            if (job.stepEnd) {
+                --unflushed_;
+                unflushedGauge_.add(-1);
+            }
+            busy_ = false;
+            changed_.notify_all();
+        }
+    }
+
+    void rethrow() {
+        if (error_) {
+            auto error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    const size_t maxUnflushedSteps_;
+    const size_t queueSize_;
+
+    util::MemoryAccount& account_;
+    util::Gauge& unflushedGauge_;
+
+    eckit::Timer timer_;
+    eckit::Timing timing_;
+
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable changed_;
+    std::deque<Job> jobs_;
+    size_t unflushed_ = 0;
+    bool busy_ = false;
+    bool closed_ = false;
+    std::exception_ptr error_;
+
+    std::thread thread_;
+};
+
 Sink::Sink(const ConfigurationContext& confCtx) :
-    Action(confCtx), report_{confCtx.config().getBool("report", true)}, mio_{confCtx} {}
+    Action(confCtx), report_{confCtx.config().getBool("report", true)}, mio_{confCtx} {
+    const auto& cfg = confCtx.config();
+    if (cfg.getBool("async-flush", eckit::Resource<bool>("multioSinkAsyncFlush;$MULTIO_SINK_ASYNC_FLUSH", false))) {
+        auto maxUnflushedSteps = cfg.getUnsigned(
+            "max-unflushed-steps",
+            eckit::Resource<size_t>("multioSinkMaxUnflushedSteps;$MULTIO_SINK_MAX_UNFLUSHED_STEPS", 1));
+        auto queueSize = cfg.getUnsigned(
+            "async-queue-size", eckit::Resource<size_t>("multioSinkAsyncQueueSize;$MULTIO_SINK_ASYNC_QUEUE_SIZE", 1024));
+        asyncFlush_.reset(new AsyncFlush{maxUnflushedSteps, queueSize});
+    }
+}
 
 Sink::~Sink() {
+    if (asyncFlush_) {
+        try {
+            asyncFlush_->drain();
+        }
+        catch (const std::exception& e) {
+            eckit::Log::error() << "Sink failed to complete asynchronous output: " << e.what() << std::endl;
+        }
+        statistics_.actionTiming_ += asyncFlush_->timing();
+        asyncFlush_.reset();
+    }
+
     if (report_) {
         std::ofstream logFile{util::logfile_name(), std::ios_base::app};
         mio_.report(logFile);
@@ -37,17 +197,43 @@ void Sink::executeImpl(Message msg) const {
     switch (msg.tag()) {
         case Message::Tag::Field:
         case Message::Tag::Grib:
-            write(msg);
+            if (asyncFlush_) {
+                // The queued copy must neither refer to caller-owned memory nor see later in-place changes
+                const Message queued = msg.share();
+                util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
+                queued.payload();
+                asyncFlush_->push([this, queued]() { write(queued); }, queued.size());
+            }
+            else {
+                util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
+                write(msg);
+            }
             executeNext(std::move(msg));
             return;
 
         case Message::Tag::StepComplete:
-            flush();
+            if (asyncFlush_) {
+                util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
+                asyncFlush_->push([this]() { flush(); }, 0, true);
+                asyncFlush_->throttle();
+            }
+            else {
+                util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
+                flush();
+            }
             executeNext(std::move(msg));
             return;
 
         case Message::Tag::StepNotification:
-            trigger(msg);
+            if (asyncFlush_) {
+                // Triggered only once the preceding flushes have completed
+                util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
+                asyncFlush_->push([this, msg]() { trigger(msg); });
+            }
+            else {
+                util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
+                trigger(msg);
+            }
             executeNext(std::move(msg));
             return;
 
@@ -57,21 +243,16 @@ void Sink::executeImpl(Message msg) const {
 }
 
 void Sink::write(Message msg) const {
-    util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
-
     eckit::message::Message blob = to_eckit_message(msg);
 
     mio_.write(blob);
 }
 
 void Sink::flush() const {
-    util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
     mio_.flush();
 }
 
 void Sink::trigger(const Message& msg) const {
-    util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
-
     eckit::StringDict metadata;
 
     metadata[msg.metadata().getString("trigger")] = msg.name();
@@ -84,7 +265,7 @@ void Sink::trigger(const Message& msg) const {
 }
 
 void Sink::print(std::ostream& os) const {
-    os << "Sink(DataSink=" << mio_ << ")";
+    os << "Sink(DataSink=" << mio_ << (asyncFlush_ ? ", async-flush" : "") << ")";
 }
 
 static ActionBuilder<Sink> SinkBuilder("sink");
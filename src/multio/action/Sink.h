@@ -18,6 +18,7 @@
 #define multio_server_actions_Sink_H
 
 #include <iosfwd>
+#include <memory>
 
 #include "multio/sink/MultIO.h"
 #include "multio/action/Action.h"
@@ -38,6 +39,8 @@ public:
     void executeImpl(message::Message msg) const override;
 
 private:
+    class AsyncFlush;
+
     void print(std::ostream& os) const override;
 
     void write(Message msg) const;
@@ -49,6 +52,10 @@ private:
     bool report_;
 
     mutable MultIO mio_;
+
+    // Set when writes, flushes and triggers run on a background thread. Declared last, so that the
+    // thread is joined before anything it uses is destroyed.
+    std::unique_ptr<AsyncFlush> asyncFlush_;
 };
 
 }  // namespace action
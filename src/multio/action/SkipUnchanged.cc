@@ -0,0 +1,216 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "SkipUnchanged.h"
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "eckit/config/Configuration.h"
+#include "eckit/exception/Exceptions.h"
+
+#include "multio/LibMultio.h"
+#include "multio/message/Metadata.h"
+#include "multio/util/Metrics.h"
+#include "multio/util/ScopedTimer.h"
+
+namespace multio {
+namespace action {
+
+using message::Message;
+
+namespace {
+
+std::vector<std::string> getKeys(const eckit::Configuration& conf) {
+    if (conf.has("keys")) {
+        return conf.getStringVector("keys");
+    }
+    return std::vector<std::string>{"category", "name", "level", "domain"};
+}
+
+bool isReference(const eckit::Configuration& conf) {
+    const auto mode = conf.getString("mode", "drop");
+    if (mode != "drop" && mode != "reference") {
+        throw eckit::UserError("Action skip-unchanged does not support mode " + mode, Here());
+    }
+    return mode == "reference";
+}
+
+// 64-bit payload hash in the style of xxHash64. Not cryptographic, but fast and well mixed: fields are
+// told apart by their key first, so it only has to catch changes of the values of the same field.
+const uint64_t prime1 = 11400714785074694791ULL;
+const uint64_t prime2 = 14029467366897019727ULL;
+const uint64_t prime3 = 1609587929392839161ULL;
+const uint64_t prime4 = 9650029242287828579ULL;
+const uint64_t prime5 = 2870177450012600261ULL;
+
+uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint64_t mixRound(uint64_t acc, uint64_t input) {
+    acc += input * prime2;
+    return rotl(acc, 31) * prime1;
+}
+
+uint64_t merge(uint64_t acc, uint64_t lane) {
+    acc ^= mixRound(0, lane);
+    return acc * prime1 + prime4;
+}
+
+uint64_t hashPayload(const void* data, size_t size) {
+    auto p = static_cast<const unsigned char*>(data);
+    const auto end = p + size;
+
+    uint64_t h;
+    if (size >= 32) {
+        uint64_t v1 = prime1 + prime2;
+        uint64_t v2 = prime2;
+        uint64_t v3 = 0;
+        uint64_t v4 = 0 - prime1;
+        do {
+            v1 = mixRound(v1, read64(p));
+            v2 = mixRound(v2, read64(p + 8));
+            v3 = mixRound(v3, read64(p + 16));
+            v4 = mixRound(v4, read64(p + 24));
+            p += 32;
+        } while (p + 32 <= end);
+
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = merge(h, v1);
+        h = merge(h, v2);
+        h = merge(h, v3);
+        h = merge(h, v4);
+    }
+    else {
+        h = prime5;
+    }
+
+    h += size;
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= mixRound(0, read64(p));
+        h = rotl(h, 27) * prime1 + prime4;
+    }
+    if (p + 4 <= end) {
+        h ^= read32(p) * prime1;
+        h = rotl(h, 23) * prime2 + prime3;
+        p += 4;
+    }
+    for (; p != end; ++p) {
+        h ^= *p * prime5;
+        h = rotl(h, 11) * prime1;
+    }
+
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    h *= prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+// Parts of a field may repeat while others change, e.g. the parts of all-land partitions, and must all reach the
+// aggregation
+bool isPartial(const Message& msg) {
+    const auto& md = msg.metadata();
+    return md.has("globalSize") && static_cast<size_t>(md.getLong("globalSize")) != msg.fieldSize();
+}
+
+}  // namespace
+
+SkipUnchanged::SkipUnchanged(const ConfigurationContext& confCtx) :
+    Action{confCtx},
+    keys_{getKeys(confCtx.config())},
+    reference_{isReference(confCtx.config())},
+    trigger_{confCtx.config().getString("trigger", "unchanged")},
+    skippedFields_{util::Metrics::instance().counter("skipped_unchanged_fields")},
+    skippedBytes_{util::Metrics::instance().counter("skipped_unchanged_bytes")} {}
+
+void SkipUnchanged::executeImpl(Message msg) const {
+    if (msg.tag() != Message::Tag::Field || isPartial(msg)) {
+        executeNext(std::move(msg));
+        return;
+    }
+
+    bool skip = false;
+    {
+        util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
+        skip = unchanged(msg);
+    }
+
+    if (not skip) {
+        executeNext(std::move(msg));
+        return;
+    }
+
+    skippedFields_.add();
+    skippedBytes_.add(msg.size());
+    LOG_DEBUG_LIB(LibMultio) << "*** Skipping unchanged field " << msg << std::endl;
+
+    if (reference_) {
+        auto md = msg.metadata();
+        md.set("trigger", trigger_);
+        executeNext(Message{Message::Header{Message::Tag::StepNotification, msg.source(), msg.destination(),
+                                            std::move(md)}});
+    }
+}
+
+std::string SkipUnchanged::fieldKey(const Message& msg) const {
+    // Partial fields of different clients are different fields, even if their metadata are the same
+    std::ostringstream os;
+    os << msg.source() << ';';
+
+    const auto& md = msg.metadata();
+    for (const auto& key : keys_) {
+        os << key << '=' << (md.has(key) ? message::to_string(md, key) : std::string{}) << ';';
+    }
+    return os.str();
+}
+
+bool SkipUnchanged::unchanged(const Message& msg) const {
+    const Fingerprint current{hashPayload(msg.payload().data(), msg.size()), msg.size()};
+
+    auto inserted = fingerprints_.emplace(fieldKey(msg), current);
+    if (inserted.second) {
+        return false;
+    }
+
+    auto& previous = inserted.first->second;
+    const auto same = previous.hash == current.hash && previous.size == current.size;
+    previous = current;
+    return same;
+}
+
+void SkipUnchanged::print(std::ostream& os) const {
+    os << "SkipUnchanged(keys=";
+    for (const auto& key : keys_) {
+        os << (&key == &keys_.front() ? "" : ",") << key;
+    }
+    os << ", mode=" << (reference_ ? "reference" : "drop") << ", fields=" << fingerprints_.size() << ")";
+}
+
+static ActionBuilder<SkipUnchanged> SkipUnchangedBuilder("skip-unchanged");
+
+}  // namespace action
+}  // namespace multio
@@ -0,0 +1,70 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Nov 2022
+
+/// Stops fields whose values have not changed since they were last passed on, e.g. static fields such
+/// as the land-sea mask or orography that are output every step. Fields are told apart by a set of
+/// metadata keys and compared by a hash of their payload. An unchanged field is either dropped or
+/// replaced by a step notification, which sinks report through their triggers. Partial fields are passed on
+/// as they are, so the action belongs after the aggregation.
+
+#ifndef multio_server_actions_SkipUnchanged_H
+#define multio_server_actions_SkipUnchanged_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "multio/action/Action.h"
+
+namespace multio {
+
+namespace util {
+class Counter;
+}
+
+namespace action {
+
+class SkipUnchanged : public Action {
+public:
+    explicit SkipUnchanged(const ConfigurationContext& confCtx);
+
+    void executeImpl(message::Message msg) const override;
+
+private:
+    struct Fingerprint {
+        uint64_t hash;
+        size_t size;
+    };
+
+    void print(std::ostream& os) const override;
+
+    std::string fieldKey(const message::Message& msg) const;
+
+    // Records the fingerprint of the field and returns whether it matches the previous one
+    bool unchanged(const message::Message& msg) const;
+
+    const std::vector<std::string> keys_;
+    const bool reference_;
+    const std::string trigger_;
+
+    mutable std::unordered_map<std::string, Fingerprint> fingerprints_;
+
+    util::Counter& skippedFields_;
+    util::Counter& skippedBytes_;
+};
+
+}  // namespace action
+}  // namespace multio
+
+#endif
@@ -11,13 +11,18 @@
 #include "Statistics.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 
+#include "eckit/config/Configuration.h"
 #include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
 
 #include "multio/LibMultio.h"
 #include "multio/action/TemporalStatistics.h"
 #include "multio/message/Message.h"
 #include "multio/util/ScopedTimer.h"
+#include "multio/util/SnapshotFile.h"
 
 namespace multio {
 namespace action {
@@ -28,6 +33,45 @@ const std::map<const char, const std::string> symbol_to_unit{{'h', "hour"}, {'d'
 
 const std::map<const std::string, long> to_hourly{{"hour", 1}, {"day", 24}};
 
+const char snapshotMagic[8] = {'M', 'I', 'O', 'S', 'T', 'A', 'T', '1'};
+
+// Snapshot layout: the magic and the number of fields, then for each field its key and the states of its levels,
+// each preceded by its size
+void append(std::vector<char>& buf, const void* data, size_t size) {
+    const auto pos = static_cast<const char*>(data);
+    buf.insert(buf.end(), pos, pos + size);
+}
+
+void appendSize(std::vector<char>& buf, size_t size) {
+    const auto value = static_cast<uint64_t>(size);
+    append(buf, &value, sizeof(value));
+}
+
+class SnapshotReader {
+public:
+    SnapshotReader(const std::vector<char>& data, const std::string& path) : data_{data}, path_{path} {}
+
+    const char* take(size_t size) {
+        if (size > data_.size() - pos_) {
+            throw eckit::SeriousBug{"Statistics snapshot " + path_ + " is truncated", Here()};
+        }
+        auto ptr = data_.data() + pos_;
+        pos_ += size;
+        return ptr;
+    }
+
+    size_t takeSize() {
+        uint64_t value;
+        std::memcpy(&value, take(sizeof(value)), sizeof(value));
+        return static_cast<size_t>(value);
+    }
+
+private:
+    const std::vector<char>& data_;
+    const std::string& path_;
+    size_t pos_ = 0;
+};
+
 std::string set_unit(std::string const& output_freq) {
     const auto& symbol = output_freq.back();
 
@@ -42,15 +86,72 @@ long set_frequency(const std::string& output_freq) {
     return std::stol(freq);
 }
 
+// Approximate length in hours, only used for ordering
+long nominal_hours(const std::string& unit, long span) {
+    return (unit == "month") ? 24 * 31 * span : to_hourly.at(unit) * span;
+}
+
+// Whether every period of the coarser frequency ends where a period of the finer one does
+template <typename Frequency>
+bool is_nested(const Frequency& finer, const Frequency& coarser) {
+    if (coarser.timeUnit == "month") {
+        return (finer.timeUnit == "month") ? (coarser.timeSpan % finer.timeSpan == 0)
+                                           : (24 % nominal_hours(finer.timeUnit, finer.timeSpan) == 0);
+    }
+    if (finer.timeUnit == "month") {
+        return false;
+    }
+    return nominal_hours(coarser.timeUnit, coarser.timeSpan) % nominal_hours(finer.timeUnit, finer.timeSpan) == 0;
+}
+
+template <typename Frequency>
+std::vector<Frequency> set_frequencies(const eckit::Configuration& cfg) {
+    auto freqs = cfg.has("output-frequencies") ? cfg.getStringVector("output-frequencies")
+                                               : std::vector<std::string>{cfg.getString("output-frequency")};
+
+    std::vector<Frequency> frequencies;
+    for (const auto& freq : freqs) {
+        frequencies.push_back(Frequency{set_unit(freq), set_frequency(freq)});
+    }
+
+    std::sort(begin(frequencies), end(frequencies), [](const Frequency& lhs, const Frequency& rhs) {
+        return nominal_hours(lhs.timeUnit, lhs.timeSpan) < nominal_hours(rhs.timeUnit, rhs.timeSpan);
+    });
+
+    for (size_t ii = 1; ii < frequencies.size(); ++ii) {
+        if (not is_nested(frequencies[ii - 1], frequencies[ii])) {
+            throw eckit::UserError{"Output frequency " + std::to_string(frequencies[ii].timeSpan)
+                                       + frequencies[ii].timeUnit + " is not a multiple of "
+                                       + std::to_string(frequencies[ii - 1].timeSpan) + frequencies[ii - 1].timeUnit,
+                                   Here()};
+        }
+    }
+
+    return frequencies;
+}
+
 }  // namespace
 
 Statistics::Statistics(const ConfigurationContext& confCtx) :
     Action{confCtx},
-    timeUnit_{set_unit(confCtx.config().getString("output-frequency"))},
-    timeSpan_{set_frequency(confCtx.config().getString("output-frequency"))},
-    operations_{confCtx.config().getStringVector("operations")} {}
+    frequencies_{set_frequencies<OutputFrequency>(confCtx.config())},
+    operations_{confCtx.config().getStringVector("operations")},
+    stateDirectory_{confCtx.config().getString("state-directory", "")} {
+    if (operations_.empty()) {
+        throw eckit::UserError{"Statistics must define at least one operation", Here()};
+    }
+    if (not stateDirectory_.empty()) {
+        eckit::PathName{stateDirectory_}.mkdir();
+        snapshotFile_.reset(new util::SnapshotFile{stateDirectory_ + "/statistics.snapshot"});
+        loadSnapshot();
+    }
+}
 
 void Statistics::executeImpl(message::Message msg) const {
+    if (msg.tag() == message::Message::Tag::StepComplete && not stateDirectory_.empty()) {
+        snapshot();
+    }
+
     // Pass through -- no statistics for messages other than fields
     if (msg.tag() != message::Message::Tag::Field) {
         executeNext(msg);
@@ -58,29 +159,58 @@ void Statistics::executeImpl(message::Message msg) const {
     }
 
     std::ostringstream os;
-    auto md = msg.metadata();
     {
         util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
 
-        LOG_DEBUG_LIB(LibMultio) << "*** " << msg.destination() << " -- metadata: " << md << std::endl;
+        LOG_DEBUG_LIB(LibMultio) << "*** " << msg.destination() << " -- metadata: " << msg.metadata()
+                                 << std::endl;
 
         // Create a unique key for the fieldStats_ map
         os << msg.metadata().getString("param") << msg.metadata().getLong("level") << msg.source();
 
-        if (fieldStats_.find(os.str()) == end(fieldStats_)) {
-            fieldStats_[os.str()] = TemporalStatistics::build(timeUnit_, timeSpan_, operations_, msg);
+        auto& levels = fieldStats_[os.str()];
+        if (levels.empty()) {
+            for (const auto& freq : frequencies_) {
+                levels.push_back(TemporalStatistics::build(freq.timeUnit, freq.timeSpan, operations_, msg));
+            }
+            if (not restoredStates_.empty()) {
+                restore(os.str());
+            }
         }
 
-        if (fieldStats_.at(os.str())->process(msg)) {
+        if (levels.front()->process(msg)) {
             return;
         }
+    }
+
+    // The finest period is complete; coarser ones are fed from it rather than from the input field
+    auto& levels = fieldStats_.at(os.str());
+    for (size_t ii = 0; ii != levels.size(); ++ii) {
+        bool coarserContinues = false;
+        if (ii + 1 != levels.size()) {
+            util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
+            coarserContinues = levels[ii + 1]->absorb(*levels[ii], msg);
+        }
+
+        emit(msg, frequencies_[ii], *levels[ii]);
+
+        if (coarserContinues) {
+            break;
+        }
+    }
+}
+
+void Statistics::emit(const message::Message& msg, const OutputFrequency& freq, TemporalStatistics& stats) const {
+    auto md = msg.metadata();
+    {
+        util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
 
-        md.set("timeUnit", timeUnit_);
-        auto timeSpanInHours = timeSpan_ * to_hourly.at(timeUnit_);
+        md.set("timeUnit", freq.timeUnit);
+        auto timeSpanInHours = freq.timeSpan * to_hourly.at(freq.timeUnit);
         md.set("timeSpanInHours", timeSpanInHours);
-        md.set("stepRange", fieldStats_.at(os.str())->stepRange(md.getLong("step")));
-        md.set("currentDate", fieldStats_.at(os.str())->current().endPoint().date().yyyymmdd());
-        md.set("currentTime", fieldStats_.at(os.str())->current().endPoint().time().hhmmss());
+        md.set("stepRange", stats.stepRange(md.getLong("step")));
+        md.set("currentDate", stats.current().endPoint().date().yyyymmdd());
+        md.set("currentTime", stats.current().endPoint().time().hhmmss());
 
         if (md.has("step") && md.has("timeStep")) {
             auto stepInSeconds = md.getLong("step") * md.getLong("timeStep");
@@ -93,23 +223,110 @@ void Statistics::executeImpl(message::Message msg) const {
             md.set("stepRangeInHours", stepRangeInHours);
         }
     }
-    for (auto&& stat : fieldStats_.at(os.str())->compute(msg)) {
+    // Results are owned by the messages, as downstream actions may keep them beyond the reset below
+    for (auto&& stat : stats.compute(msg)) {
         md.set("operation", stat.first);
         message::Message newMsg{message::Message::Header{message::Message::Tag::Field, msg.source(), msg.destination(),
                                                          message::Metadata{md}},
                                 std::move(stat.second)};
-        
-        executeNext(newMsg);
+
+        executeNext(std::move(newMsg));
     }
 
     util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
 
-    fieldStats_.at(os.str())->reset(msg);
+    stats.reset(msg);
+}
+
+void Statistics::loadSnapshot() {
+    const auto data = snapshotFile_->read();
+    if (data.empty()) {
+        return;
+    }
+
+    SnapshotReader reader{data, snapshotFile_->path()};
+    if (std::memcmp(reader.take(sizeof(snapshotMagic)), snapshotMagic, sizeof(snapshotMagic)) != 0) {
+        throw eckit::SeriousBug{"File " + snapshotFile_->path() + " is not a statistics snapshot", Here()};
+    }
+
+    auto fields = reader.takeSize();
+    for (size_t ii = 0; ii != fields; ++ii) {
+        auto keySize = reader.takeSize();
+        std::string key{reader.take(keySize), keySize};
+
+        auto& states = restoredStates_[key];
+        auto levels = reader.takeSize();
+        for (size_t jj = 0; jj != levels; ++jj) {
+            auto size = reader.takeSize();
+            auto state = reader.take(size);
+            states.emplace_back(state, state + size);
+        }
+    }
+}
+
+void Statistics::restore(const std::string& key) const {
+    auto it = restoredStates_.find(key);
+    if (it == end(restoredStates_)) {
+        return;
+    }
+
+    const auto& levels = fieldStats_.at(key);
+    if (it->second.size() != levels.size()) {
+        throw eckit::UserError{"Statistics snapshot " + snapshotFile_->path() + " holds other output frequencies",
+                               Here()};
+    }
+    for (size_t ii = 0; ii != levels.size(); ++ii) {
+        levels[ii]->restoreState(it->second[ii].data(), it->second[ii].size());
+    }
+
+    restoredStates_.erase(it);
+}
+
+void Statistics::snapshot() const {
+    util::ScopedTiming timing{statistics_.localTimer_, statistics_.actionTiming_};
+
+    // The buffer keeps its capacity from one step to the next
+    snapshotBuffer_.clear();
+    append(snapshotBuffer_, snapshotMagic, sizeof(snapshotMagic));
+    appendSize(snapshotBuffer_, fieldStats_.size() + restoredStates_.size());
+
+    for (const auto& field : fieldStats_) {
+        appendSize(snapshotBuffer_, field.first.size());
+        append(snapshotBuffer_, field.first.data(), field.first.size());
+        appendSize(snapshotBuffer_, field.second.size());
+        for (const auto& level : field.second) {
+            auto size = level->stateSize();
+            appendSize(snapshotBuffer_, size);
+            auto pos = snapshotBuffer_.size();
+            snapshotBuffer_.resize(pos + size);
+            level->saveState(snapshotBuffer_.data() + pos);
+        }
+    }
+
+    // Fields not seen again since the restart keep their snapshotted states
+    for (const auto& field : restoredStates_) {
+        appendSize(snapshotBuffer_, field.first.size());
+        append(snapshotBuffer_, field.first.data(), field.first.size());
+        appendSize(snapshotBuffer_, field.second.size());
+        for (const auto& state : field.second) {
+            appendSize(snapshotBuffer_, state.size());
+            append(snapshotBuffer_, state.data(), state.size());
+        }
+    }
+
+    snapshotFile_->write(snapshotBuffer_.data(), snapshotBuffer_.size());
 }
 
 void Statistics::print(std::ostream& os) const {
-    os << "Statistics(output frequency = " << timeSpan_ << ", unit = " << timeUnit_ << ", operations = ";
+    os << "Statistics(output frequency = ";
     bool first = true;
+    for (const auto& freq : frequencies_) {
+        os << (first ? "" : ", ");
+        os << freq.timeSpan << " " << freq.timeUnit;
+        first = false;
+    }
+    os << ", operations = ";
+    first = true;
     for (const auto& ops : operations_) {
         os << (first ? "" : ", ");
         os << ops;
@@ -17,6 +17,9 @@
 #define multio_server_actions_Statistics_H
 
 #include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "multio/action/Action.h"
@@ -24,6 +27,11 @@
 namespace eckit { class Configuration; }
 
 namespace multio {
+
+namespace util {
+class SnapshotFile;
+}
+
 namespace action {
 
 class TemporalStatistics;
@@ -35,14 +43,37 @@ public:
     void executeImpl(message::Message msg) const override;
 
 private:
+    // Output frequency of the form <span><unit>, e.g. 6h, 10d or 1m
+    struct OutputFrequency {
+        std::string timeUnit;
+        long timeSpan;
+    };
+
     void print(std::ostream &os) const override;
 
-    const std::string timeUnit_;
-    const long timeSpan_;
+    void emit(const message::Message& msg, const OutputFrequency& freq, TemporalStatistics& stats) const;
+
+    void loadSnapshot();
+    void restore(const std::string& key) const;
+    void snapshot() const;
+
+    // Ordered from the finest to the coarsest period
+    const std::vector<OutputFrequency> frequencies_;
 
     const std::vector<std::string> operations_;
 
-    mutable std::map<std::string, std::unique_ptr<TemporalStatistics>> fieldStats_;
+    // Snapshots of the statistics are kept here if set
+    const std::string stateDirectory_;
+
+    // One level per output frequency; only the finest one sees the incoming fields
+    mutable std::map<std::string, std::vector<std::unique_ptr<TemporalStatistics>>> fieldStats_;
+
+    // One snapshot of all fields, written whenever a step is complete
+    std::unique_ptr<util::SnapshotFile> snapshotFile_;
+    mutable std::vector<char> snapshotBuffer_;
+
+    // Snapshotted states of the fields that have not been seen again since the restart, one per level
+    mutable std::map<std::string, std::vector<std::vector<char>>> restoredStates_;
 };
 
 }  // namespace action
@@ -1,6 +1,8 @@
 
 #include "TemporalStatistics.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 
@@ -11,8 +13,8 @@ namespace multio {
 namespace action {
 
 namespace  {
-std::vector<std::unique_ptr<Operation>> reset_statistics(const std::vector<std::string>& opNames,
-                                                         long sz) {
+std::vector<std::unique_ptr<Operation>> make_statistics(const std::vector<std::string>& opNames,
+                                                        long sz) {
     std::vector<std::unique_ptr<Operation>> stats;
     for (const auto& op : opNames) {
         stats.push_back(make_operation(op, sz));
@@ -55,16 +57,43 @@ TemporalStatistics::TemporalStatistics(const std::string& name, const DateTimePe
     name_{name},
     current_{period},
     opNames_{operations},
-    statistics_{reset_statistics(operations, sz)} {}
+    statistics_{make_statistics(operations, sz)} {
+    if (statistics_.empty()) {
+        throw eckit::UserError{"Temporal statistics " + name_ + " must compute at least one operation", Here()};
+    }
+}
 
 bool TemporalStatistics::process(message::Message& msg) {
+    auto step = msg.metadata().getLong("step");
+    if (step <= restoredStep_) {
+        LOG_DEBUG_LIB(LibMultio) << " *** Step " << step << " of " << name_ << " is part of the restored state"
+                                 << std::endl;
+        return true;
+    }
+    lastStep_ = step;
+
     return process_next(msg);
 }
 
 void TemporalStatistics::updateStatistics(const message::Message& msg) {
-    auto data_ptr = static_cast<const double*>(msg.payload().data());
-    for(auto const& stat : statistics_) {
-        stat->update(data_ptr, msg.size() / sizeof(double));
+    // Accumulation is always done in double precision
+    switch (msg.precision()) {
+        case message::Message::Precision::Single: {
+            auto data_ptr = static_cast<const float*>(msg.payload().data());
+            for (auto const& stat : statistics_) {
+                stat->update(data_ptr, msg.fieldSize());
+            }
+            break;
+        }
+        case message::Message::Precision::Double: {
+            auto data_ptr = static_cast<const double*>(msg.payload().data());
+            for (auto const& stat : statistics_) {
+                stat->update(data_ptr, msg.fieldSize());
+            }
+            break;
+        }
+        default:
+            NOTIMP;
     }
 }
 
@@ -89,6 +118,25 @@ bool TemporalStatistics::process_next(message::Message& msg) {
     return current_.isWithin(dateTime);
 }
 
+bool TemporalStatistics::absorb(const TemporalStatistics& finer, const message::Message& msg) {
+    ASSERT(name_ == finer.name_);
+    ASSERT(opNames_ == finer.opNames_);
+
+    auto dateTime = currentDateTime(msg);
+    if (!current_.isWithin(dateTime)) {
+        std::ostringstream os;
+        os << dateTime << " is outside of current period " << current_ << std::endl;
+        throw eckit::AssertionFailed(os.str());
+    }
+
+    for (size_t ii = 0; ii != statistics_.size(); ++ii) {
+        statistics_[ii]->merge(*finer.statistics_[ii]);
+    }
+
+    dateTime = dateTime + static_cast<eckit::Second>(msg.metadata().getLong("timeStep"));
+    return current_.isWithin(dateTime);
+}
+
 void TemporalStatistics::resetPeriod(const message::Message& msg) {
     current_.reset(currentDateTime(msg));
 }
@@ -96,9 +144,17 @@ void TemporalStatistics::resetPeriod(const message::Message& msg) {
 std::map<std::string, eckit::Buffer> TemporalStatistics::compute(const message::Message& msg) {
     std::map<std::string, eckit::Buffer> retStats;
     for (auto const& stat : statistics_) {
+        ASSERT(msg.size() == stat->size() * message::Message::sizeOf(msg.precision()));
+
         eckit::Buffer buf{msg.size()};
-        const auto& res = stat->compute();
-        std::memcpy(buf, res.data(), msg.size());
+        const auto values = stat->compute();
+        if (msg.precision() == message::Message::Precision::Single) {
+            // Results are returned in the precision of the incoming field
+            std::copy(values, values + stat->size(), static_cast<float*>(buf.data()));
+        }
+        else {
+            std::memcpy(buf, values, msg.size());
+        }
         retStats.emplace(stat->name(), std::move(buf));
     }
     return retStats;
@@ -116,12 +172,140 @@ const DateTimePeriod& TemporalStatistics::current() const {
 }
 
 void TemporalStatistics::reset(const message::Message& msg) {
-    statistics_ = reset_statistics(opNames_, msg.size() / sizeof(double));
+    ASSERT(static_cast<long>(msg.fieldSize()) == statistics_.front()->size());
+
+    for (auto const& stat : statistics_) {
+        stat->reset();
+    }
     resetPeriod(msg);
     LOG_DEBUG_LIB(LibMultio) << " ------ Resetting statistics for temporal type " << *this
                              << std::endl;
 }
 
+namespace {
+// State layout: magic, version, length of the operation names, the comma-separated names padded to 8 bytes,
+// then stateHeaderSize fields, one counter per operation and the values of all operations
+const char stateMagic[8] = {'M', 'I', 'O', 'S', 'T', 'A', 'T', 'S'};
+const int64_t stateVersion = 1;
+const size_t stateHeaderSize = 8;
+
+std::string joinNames(const std::vector<std::string>& names) {
+    std::string joined;
+    for (const auto& name : names) {
+        joined += (joined.empty() ? "" : ",") + name;
+    }
+    return joined;
+}
+
+size_t paddedSize(size_t size) {
+    return ((size + sizeof(int64_t) - 1) / sizeof(int64_t)) * sizeof(int64_t);
+}
+
+int64_t dateOf(const eckit::DateTime& dt) {
+    return dt.date().yyyymmdd();
+}
+
+int64_t timeOf(const eckit::DateTime& dt) {
+    return dt.time().hhmmss();
+}
+
+eckit::DateTime toDateTime(int64_t date, int64_t time) {
+    return eckit::DateTime{eckit::Date{static_cast<long>(date)},
+                           eckit::Time{static_cast<long>(time / 10000), static_cast<long>((time % 10000) / 100),
+                                       static_cast<long>(time % 100)}};
+}
+}  // namespace
+
+size_t TemporalStatistics::stateSize() const {
+    auto size = static_cast<size_t>(statistics_.front()->size());
+    return sizeof(stateMagic) + 2 * sizeof(int64_t) + paddedSize(joinNames(opNames_).size())
+         + (stateHeaderSize + statistics_.size()) * sizeof(int64_t) + statistics_.size() * size * sizeof(double);
+}
+
+size_t TemporalStatistics::saveState(char* buf) const {
+    auto size = statistics_.front()->size();
+    const auto names = joinNames(opNames_);
+
+    auto pos = buf;
+    std::memcpy(pos, stateMagic, sizeof(stateMagic));
+    pos += sizeof(stateMagic);
+
+    const int64_t prologue[2] = {stateVersion, static_cast<int64_t>(names.size())};
+    std::memcpy(pos, prologue, sizeof(prologue));
+    pos += sizeof(prologue);
+
+    std::memset(pos, 0, paddedSize(names.size()));
+    std::memcpy(pos, names.data(), names.size());
+    pos += paddedSize(names.size());
+
+    std::vector<int64_t> header{dateOf(current_.startPoint()),
+                                timeOf(current_.startPoint()),
+                                dateOf(current_.endPoint()),
+                                timeOf(current_.endPoint()),
+                                prevStep_,
+                                lastStep_,
+                                static_cast<int64_t>(statistics_.size()),
+                                size};
+    for (auto const& stat : statistics_) {
+        header.push_back(stat->counter());
+    }
+
+    std::memcpy(pos, header.data(), header.size() * sizeof(int64_t));
+    pos += header.size() * sizeof(int64_t);
+    for (auto const& stat : statistics_) {
+        std::memcpy(pos, stat->values(), size * sizeof(double));
+        pos += size * sizeof(double);
+    }
+
+    ASSERT(static_cast<size_t>(pos - buf) == stateSize());
+    return stateSize();
+}
+
+void TemporalStatistics::restoreState(const char* buf, size_t bufSize) {
+    if (bufSize < sizeof(stateMagic) + 2 * sizeof(int64_t)
+        || std::memcmp(buf, stateMagic, sizeof(stateMagic)) != 0) {
+        throw eckit::SeriousBug{"Snapshot of " + name_ + " is not a statistics snapshot", Here()};
+    }
+
+    int64_t prologue[2];
+    std::memcpy(prologue, buf + sizeof(stateMagic), sizeof(prologue));
+    if (prologue[0] != stateVersion) {
+        throw eckit::SeriousBug{"Snapshot of " + name_ + " has unsupported version " + std::to_string(prologue[0]),
+                                Here()};
+    }
+
+    const auto names = joinNames(opNames_);
+    const auto namesPos = buf + sizeof(stateMagic) + sizeof(prologue);
+    const auto savedLength = static_cast<size_t>(prologue[1]);
+    if (savedLength > bufSize - sizeof(stateMagic) - sizeof(prologue)
+        || std::string(namesPos, savedLength) != names) {
+        throw eckit::UserError{"Snapshot of " + name_ + " holds other operations than the configured " + names,
+                               Here()};
+    }
+
+    if (bufSize != stateSize()) {
+        throw eckit::SeriousBug{"Snapshot of " + name_ + " does not match the configured statistics", Here()};
+    }
+
+    const auto statePos = namesPos + paddedSize(names.size());
+    auto header = reinterpret_cast<const int64_t*>(statePos);
+    auto size = statistics_.front()->size();
+    ASSERT(header[6] == static_cast<int64_t>(statistics_.size()));
+    ASSERT(header[7] == size);
+
+    current_.reset(toDateTime(header[0], header[1]), toDateTime(header[2], header[3]));
+    prevStep_ = header[4];
+    lastStep_ = header[5];
+    restoredStep_ = lastStep_;
+
+    auto values = reinterpret_cast<const double*>(statePos + (stateHeaderSize + statistics_.size()) * sizeof(int64_t));
+    for (size_t ii = 0; ii != statistics_.size(); ++ii) {
+        statistics_[ii]->restore(values + ii * size, header[stateHeaderSize + ii]);
+    }
+
+    LOG_DEBUG_LIB(LibMultio) << " *** Restored " << *this << " up to step " << lastStep_ << std::endl;
+}
+
 //-------------------------------------------------------------------------------------------------
 
 HourlyStatistics::HourlyStatistics(const std::vector<std::string> operations, long span,
@@ -131,7 +315,7 @@ HourlyStatistics::HourlyStatistics(const std::vector<std::string> operations, lo
         DateTimePeriod{
             eckit::DateTime{eckit::Date{msg.metadata().getLong("startDate")}, eckit::Time{0}},
             static_cast<eckit::Second>(3600 * span)},
-        operations, msg.size() / sizeof(double)} {}
+        operations, msg.fieldSize()} {}
 
 void HourlyStatistics::print(std::ostream &os) const {
     os << "Hourly Statistics(" << current_ << ")";
@@ -146,7 +330,7 @@ DailyStatistics::DailyStatistics(const std::vector<std::string> operations, long
         DateTimePeriod{
             eckit::DateTime{eckit::Date{msg.metadata().getLong("startDate")}, eckit::Time{0}},
             static_cast<eckit::Second>(24 * 3600 * span)},
-        operations, msg.size() / sizeof(double)} {}
+        operations, msg.fieldSize()} {}
 
 void DailyStatistics::print(std::ostream &os) const {
     os << "Daily Statistics(" << current_ << ")";
@@ -175,7 +359,7 @@ DateTimePeriod setMonthlyPeriod(long span, const message::Message& msg) {
 MonthlyStatistics::MonthlyStatistics(const std::vector<std::string> operations, long span,
                                      message::Message msg) :
     TemporalStatistics{msg.name(), setMonthlyPeriod(span, msg), operations,
-                       msg.size() / sizeof(double)} {}
+                       msg.fieldSize()} {}
 
 void MonthlyStatistics::print(std::ostream& os) const {
     os << "Monthly Statistics(" << current_ << ")";
@@ -2,7 +2,9 @@
 #ifndef multio_server_actions_TemporalStatistics_H
 #define multio_server_actions_TemporalStatistics_H
 
+#include <limits>
 #include <map>
+#include <memory>
 #include <string>
 
 #include "eckit/types/DateTime.h"
@@ -25,11 +27,23 @@ public:
     virtual ~TemporalStatistics() = default;
 
     bool process(message::Message& msg);
+
+    // Fold in the statistics of a finer period that has just been completed by msg. Returns whether the
+    // current (coarser) period continues beyond msg, as process() does.
+    bool absorb(const TemporalStatistics& finer, const message::Message& msg);
+
+    // Results are copied out of the accumulators, so that they outlive the next reset
     std::map<std::string, eckit::Buffer> compute(const message::Message& msg);
     std::string stepRange(long step);
     const DateTimePeriod& current() const;
     void reset(const message::Message& msg);
 
+    // Snapshot of the accumulated state. After a restore, fields up to the last step included in the
+    // snapshot are ignored, so that a restarted model may replay them.
+    size_t stateSize() const;
+    size_t saveState(char* buf) const;
+    void restoreState(const char* buf, size_t size);
+
 protected:
 
     std::string name_;
@@ -52,6 +66,8 @@ private:
     std::vector<std::string> opNames_;
     std::vector<std::unique_ptr<Operation>> statistics_;
     long prevStep_ = 0;
+    long lastStep_ = std::numeric_limits<long>::min();
+    long restoredStep_ = std::numeric_limits<long>::min();
 };
 
 //-------------------------------------------------------------------------------------------------
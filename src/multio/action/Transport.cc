@@ -17,6 +17,7 @@
 #include "multio/transport/TransportRegistry.h"
 #include "multio/util/ConfigurationPath.h"
 #include "multio/util/ScopedTimer.h"
+#include "multio/util/Tracing.h"
 #include "multio/util/logfile_name.h"
 
 namespace multio {
@@ -36,6 +37,16 @@ std::vector<std::string> getHashKeys(const eckit::Configuration& conf) {
     }
     return std::vector<std::string>{"category", "name", "level"};
 }
+
+// Carries the trace over to the header sent to the server, also for messages created by earlier actions
+Message::Header traced(Message::Header&& header, const Message& msg) {
+    if (util::Tracer::enabled()) {
+        auto id = msg.header().traceId() != 0 ? msg.header().traceId() : util::TraceSpan::current();
+        auto timestamp = msg.header().traceTimestamp() != 0 ? msg.header().traceTimestamp() : util::Tracer::now();
+        header.setTrace(id, timestamp);
+    }
+    return std::move(header);
+}
 }  // namespace
 
 Transport::Transport(const ConfigurationContext& confCtx) :
@@ -59,7 +70,7 @@ void Transport::executeImpl(Message msg) const {
     if (md.getBool("toAllServers")) {
         for (auto& server : serverPeers_) {
             auto md = msg.metadata();
-            Message trMsg{Message::Header{msg.tag(), client_, *server, std::move(md)},
+            Message trMsg{traced(Message::Header{msg.tag(), client_, *server, std::move(md)}, msg),
                           msg.payload()};
 
             transport_->send(trMsg);
@@ -68,8 +79,8 @@ void Transport::executeImpl(Message msg) const {
     else {
         auto server = chooseServer(msg.metadata());
 
-        Message trMsg{Message::Header{msg.tag(), client_, server, std::move(md)},
-                      std::move(msg.payload())};
+        // Shares the payload, so that borrowed payloads are only copied when serialised
+        auto trMsg = msg.modifyHeader(traced(Message::Header{msg.tag(), client_, server, std::move(md)}, msg));
 
         transport_->bufferedSend(trMsg);
     }
@@ -12,6 +12,7 @@ module multio_api
 
     private
 
+    integer, parameter :: sp = selected_real_kind(6, 37)
     integer, parameter :: dp = selected_real_kind(15, 307)
     integer, parameter :: double_size = 8 !c_sizeof(1.0_dp) !intel compiler...
     integer, parameter :: int64 = selected_int_kind(15)
@@ -38,10 +39,15 @@ module multio_api
         procedure :: delete => multio_delete_handle
         procedure :: open_connections => multio_open_connections
         procedure :: close_connections => multio_close_connections
+        procedure :: flush => multio_flush
         procedure :: write_step_complete => multio_write_step_complete
         procedure :: write_domain => multio_write_domain
         procedure :: write_mask => multio_write_mask
         procedure :: write_field => multio_write_field
+        procedure :: write_field_float => multio_write_field_float
+        procedure :: write_field_nocopy => multio_write_field_nocopy
+        procedure :: write_fields => multio_write_fields
+        procedure :: wait => multio_wait
         procedure :: field_is_active => multio_field_is_active
         procedure :: category_is_fully_active => multio_category_is_fully_active
     end type
@@ -268,6 +274,14 @@ module multio_api
             integer(c_int) :: err
         end function
 
+        function c_multio_flush(handle) result(err) &
+                bind(c, name='multio_flush')
+            use, intrinsic :: iso_c_binding
+            implicit none
+            type(c_ptr), intent(in), value :: handle
+            integer(c_int) :: err
+        end function
+
         function c_multio_write_step_complete(handle, metadata) result(err) &
                 bind(c, name='multio_write_step_complete')
             use, intrinsic :: iso_c_binding
@@ -309,6 +323,48 @@ module multio_api
             integer(c_int), intent(in), value :: size
             integer(c_int) :: err
         end function
+
+        function c_multio_write_field_float(handle, metadata, data, size) result(err) &
+                bind(c, name='multio_write_field_float')
+            use, intrinsic :: iso_c_binding
+            implicit none
+            type(c_ptr), intent(in), value :: handle
+            type(c_ptr), intent(in), value :: metadata
+            real(c_float), dimension(*), intent(in) :: data
+            integer(c_int), intent(in), value :: size
+            integer(c_int) :: err
+        end function
+
+        function c_multio_write_fields(handle, metadata, data, sizes, count) result(err) &
+                bind(c, name='multio_write_fields')
+            use, intrinsic :: iso_c_binding
+            implicit none
+            type(c_ptr), intent(in), value :: handle
+            type(c_ptr), dimension(*), intent(in) :: metadata
+            type(c_ptr), dimension(*), intent(in) :: data
+            integer(c_int), dimension(*), intent(in) :: sizes
+            integer(c_int), intent(in), value :: count
+            integer(c_int) :: err
+        end function
+
+        function c_multio_write_field_nocopy(handle, metadata, data, size) result(err) &
+                bind(c, name='multio_write_field_nocopy')
+            use, intrinsic :: iso_c_binding
+            implicit none
+            type(c_ptr), intent(in), value :: handle
+            type(c_ptr), intent(in), value :: metadata
+            type(c_ptr), intent(in), value :: data
+            integer(c_int), intent(in), value :: size
+            integer(c_int) :: err
+        end function
+
+        function c_multio_wait(handle) result(err) &
+                bind(c, name='multio_wait')
+            use, intrinsic :: iso_c_binding
+            implicit none
+            type(c_ptr), intent(in), value :: handle
+            integer(c_int) :: err
+        end function
         
         function c_multio_field_is_active(handle, field, set_value) result(err) &
                 bind(c, name='multio_field_is_active')
@@ -585,6 +641,12 @@ contains
         err = c_multio_close_connections(handle%impl)
     end function
 
+    function multio_flush(handle) result(err)
+        class(multio_handle), intent(inout) :: handle
+        integer :: err
+        err = c_multio_flush(handle%impl)
+    end function
+
     function multio_write_step_complete(handle, metadata) result(err)
         class(multio_handle), intent(inout) :: handle
         class(multio_metadata), intent(in) :: metadata
@@ -620,6 +682,64 @@ contains
         integer, intent(in), value :: size
         err = c_multio_write_field(handle%impl, metadata%impl, data, size)
     end function
+
+    function multio_write_field_float(handle, metadata, data, size) result(err)
+        class(multio_handle), intent(inout) :: handle
+        class(multio_metadata), intent(in) :: metadata
+        integer :: err
+
+        real(sp), dimension(*), intent(in) :: data
+        integer, intent(in), value :: size
+        err = c_multio_write_field_float(handle%impl, metadata%impl, data, size)
+    end function
+
+    ! Writes count fields of equal size, stored contiguously, e.g. the levels of a 3D field. The data is
+    ! referenced only until the call returns, so a temporary copy of a non-contiguous section is safe.
+    function multio_write_fields(handle, metadata, data, size, count) result(err)
+        class(multio_handle), intent(inout) :: handle
+        class(multio_metadata), dimension(:), intent(in) :: metadata
+        integer :: err
+
+        integer, intent(in), value :: size
+        integer, intent(in), value :: count
+        real(dp), dimension(size, count), intent(in), target :: data
+
+        type(c_ptr), dimension(count) :: metadata_ptrs
+        type(c_ptr), dimension(count) :: data_ptrs
+        integer(c_int), dimension(count) :: sizes
+        integer :: i
+
+        do i = 1, count
+            metadata_ptrs(i) = metadata(i)%impl
+            data_ptrs(i) = c_loc(data(1, i))
+            sizes(i) = size
+        end do
+
+        err = c_multio_write_fields(handle%impl, metadata_ptrs, data_ptrs, sizes, count)
+    end function
+
+    ! The data is referenced, not copied -- it must be left untouched until wait returns. Non-contiguous
+    ! arrays are rejected, as any copy made for them would not outlive this call.
+    function multio_write_field_nocopy(handle, metadata, data, size) result(err)
+        class(multio_handle), intent(inout) :: handle
+        class(multio_metadata), intent(in) :: metadata
+        integer :: err
+
+        real(dp), dimension(:), intent(in), target :: data
+        integer, intent(in), value :: size
+
+        if (.not. is_contiguous(data)) then
+            err = MULTIO_ERROR_GENERAL_EXCEPTION
+            return
+        end if
+        err = c_multio_write_field_nocopy(handle%impl, metadata%impl, c_loc(data), size)
+    end function
+
+    function multio_wait(handle) result(err)
+        class(multio_handle), intent(inout) :: handle
+        integer :: err
+        err = c_multio_wait(handle%impl)
+    end function
     
     function multio_field_is_active(handle, field, set_value) result(err)
         class(multio_handle), intent(inout) :: handle
@@ -260,6 +260,14 @@ int multio_close_connections(multio_handle_t* mio) {
     });
 }
 
+int multio_flush(multio_handle_t* mio) {
+    return wrapApiFunction([mio]() {
+        ASSERT(mio);
+
+        mio->flush();
+    });
+}
+
 int multio_write_step_complete(multio_handle_t* mio, multio_metadata_t* md) {
     return wrapApiFunction([mio, md]() {
         ASSERT(mio);
@@ -307,6 +315,55 @@ int multio_write_field(multio_handle_t* mio, multio_metadata_t* md, const double
     });
 }
 
+int multio_write_field_float(multio_handle_t* mio, multio_metadata_t* md, const float* data, int size) {
+    return wrapApiFunction([mio, md, data, size]() {
+        ASSERT(mio);
+        ASSERT(md);
+
+        Metadata fmd{*md};
+        fmd.set("precision", "single");
+
+        eckit::Buffer field_vals{reinterpret_cast<const char*>(data), size * sizeof(float)};
+
+        mio->dispatch(std::move(fmd), std::move(field_vals), Message::Tag::Field);
+    });
+}
+
+int multio_write_fields(multio_handle_t* mio, multio_metadata_t** mds, const double** data, const int* sizes,
+                        int count) {
+    return wrapApiFunction([mio, mds, data, sizes, count]() {
+        ASSERT(mio);
+        ASSERT(count >= 0);
+        ASSERT(count == 0 || (mds && data && sizes));
+
+        std::vector<multio_handle_t::BorrowedField> fields;
+        fields.reserve(count);
+        for (int i = 0; i != count; ++i) {
+            ASSERT(mds[i]);
+            fields.push_back(multio_handle_t::BorrowedField{mds[i], data[i], sizes[i] * sizeof(double)});
+        }
+
+        mio->dispatchBorrowed(fields, Message::Tag::Field);
+    });
+}
+
+int multio_write_field_nocopy(multio_handle_t* mio, multio_metadata_t* md, const double* data, int size) {
+    return wrapApiFunction([mio, md, data, size]() {
+        ASSERT(mio);
+        ASSERT(md);
+
+        mio->dispatchBorrowed(*md, data, size * sizeof(double), Message::Tag::Field);
+    });
+}
+
+int multio_wait(multio_handle_t* mio) {
+    return wrapApiFunction([mio]() {
+        ASSERT(mio);
+
+        mio->waitBorrowed();
+    });
+}
+
 int multio_new_metadata(multio_metadata_t** md) {
     return wrapApiFunction([md]() { (*md) = new multio_metadata_t{}; });
 }
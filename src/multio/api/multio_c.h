@@ -198,6 +198,14 @@ int multio_open_connections(multio_handle_t* mio);
 int multio_close_connections(multio_handle_t* mio);
 
 
+/** Waits until all messages passed to the multio (client) instance have been processed
+ * \note Only relevant with asynchronous dispatch, which is enabled by the client configuration
+ * \param mio Handle to the multio (client) instance
+ * \returns Return code (#MultioErrorValues)
+ */
+int multio_flush(multio_handle_t* mio);
+
+
 /** Indicates that a given step is complete
  * \note Can be used for checkpointing
  * \param mio Handle to the multio (client) instance
@@ -237,6 +245,53 @@ int multio_write_mask(multio_handle_t* mio, multio_metadata_t* md, const double*
 int multio_write_field(multio_handle_t* mio, multio_metadata_t* md, const double* data, int size);
 
 
+/** Writes (partial) fields in single precision
+ * \note The values are kept in single precision until they are encoded
+ * \param mio Handle to the multio (client) instance
+ * \param md Metadata information about the field
+ * \param data Pointer to the data containing the (partial) field values
+ * \param size Size of the data containing the (partial) field values
+ * \returns Return code (#MultioErrorValues)
+ */
+int multio_write_field_float(multio_handle_t* mio, multio_metadata_t* md, const float* data, int size);
+
+
+/** Writes a batch of (partial) fields, e.g. all levels of a 3D field, in a single call
+ * \note The data is referenced rather than copied, the call returns once multio no longer refers to it
+ * \param mio Handle to the multio (client) instance
+ * \param mds Array of metadata information, one per field
+ * \param data Array of pointers to the data containing the (partial) field values, one per field
+ * \param sizes Array of sizes of the data containing the (partial) field values, one per field
+ * \param count Number of fields in the batch
+ * \returns Return code (#MultioErrorValues)
+ */
+int multio_write_fields(multio_handle_t* mio, multio_metadata_t** mds, const double** data, const int* sizes,
+                        int count);
+
+
+/** Writes (partial) fields without copying the data
+ * \note The data is referenced rather than copied and must not be modified or freed until #multio_wait
+ *       has returned
+ * \note Any action may be used in the plans. Actions that keep fields beyond the call, i.e. aggregation,
+ *       statistics and sinks flushing asynchronously, copy the data as they receive it, and transports
+ *       serialise it straight away
+ * \param mio Handle to the multio (client) instance
+ * \param md Metadata information about the field
+ * \param data Pointer to the data containing the (partial) field values
+ * \param size Size of the data containing the (partial) field values
+ * \returns Return code (#MultioErrorValues)
+ */
+int multio_write_field_nocopy(multio_handle_t* mio, multio_metadata_t* md, const double* data, int size);
+
+
+/** Waits until multio no longer refers to any data passed with #multio_write_field_nocopy
+ * \note Data arrays may safely be overwritten once this call has returned
+ * \param mio Handle to the multio (client) instance
+ * \returns Return code (#MultioErrorValues)
+ */
+int multio_wait(multio_handle_t* mio);
+
+
 /** @} */
 
 
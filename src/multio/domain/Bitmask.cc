@@ -0,0 +1,49 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "Bitmask.h"
+
+#include <bitset>
+
+namespace multio {
+namespace domain {
+
+constexpr size_t Bitmask::wordBits;
+
+Bitmask::Bitmask(const std::vector<bool>& bits) :
+    size_{bits.size()}, words_((bits.size() + wordBits - 1) / wordBits, 0) {
+    for (size_t idx = 0; idx != size_; ++idx) {
+        if (bits[idx]) {
+            words_[idx / wordBits] |= uint64_t{1} << (idx % wordBits);
+        }
+    }
+}
+
+const std::vector<int32_t>& Bitmask::wetPoints() const {
+    std::call_once(wetPointsFlag_, [this]() {
+        size_t count = 0;
+        for (auto word : words_) {
+            count += std::bitset<wordBits>(word).count();
+        }
+        wetPoints_.reserve(count);
+
+        for (size_t w = 0; w != words_.size(); ++w) {
+            for (auto word = words_[w]; word != 0; word &= word - 1) {
+                // Index of the lowest set bit
+                auto bit = std::bitset<wordBits>((word & (~word + 1)) - 1).count();
+                wetPoints_.push_back(static_cast<int32_t>(w * wordBits + bit));
+            }
+        }
+    });
+    return wetPoints_;
+}
+
+}  // namespace domain
+}  // namespace multio
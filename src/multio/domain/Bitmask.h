@@ -0,0 +1,55 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2022
+
+#ifndef multio_domain_Bitmask_H
+#define multio_domain_Bitmask_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace multio {
+namespace domain {
+
+// Global mask packed into 64-bit words; bit i of word w refers to point 64 * w + i. Bits beyond the
+// size of the mask are zero.
+class Bitmask {
+public:
+    static constexpr size_t wordBits = 64;
+
+    explicit Bitmask(const std::vector<bool>& bits);
+
+    Bitmask(const Bitmask& rhs) = delete;
+    Bitmask& operator=(const Bitmask& rhs) = delete;
+
+    bool operator[](size_t idx) const { return (words_[idx / wordBits] >> (idx % wordBits)) & 1u; }
+
+    size_t size() const { return size_; }
+
+    const std::vector<uint64_t>& words() const { return words_; }
+
+    // Indices of the points that are set, computed on first use
+    const std::vector<int32_t>& wetPoints() const;
+
+private:
+    size_t size_;
+    std::vector<uint64_t> words_;
+
+    mutable std::once_flag wetPointsFlag_;
+    mutable std::vector<int32_t> wetPoints_;
+};
+
+}  // namespace domain
+}  // namespace multio
+
+#endif
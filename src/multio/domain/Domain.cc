@@ -1,8 +1,13 @@
 
 #include "Domain.h"
 
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
 #include "eckit/exception/Exceptions.h"
 
+#include "multio/domain/IndexCoverage.h"
 #include "multio/message/Message.h"
 #include "multio/LibMultio.h"
 #include "multio/util/print_buffer.h"
@@ -16,24 +21,84 @@ Domain::Domain(std::vector<int32_t>&& def) : definition_(std::move(def)) {}
 
 Unstructured::Unstructured(std::vector<int32_t>&& def, long global_size_val) : Domain{std::move(def)}, global_size_{global_size_val} {}
 
+namespace {
+// Distance, in points, at which the randomly accessed global field is prefetched
+const size_t prefetchDistance = 16;
+
+template <typename T>
+inline void prefetchRead(const T* ptr) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(ptr, 0);
+#endif
+}
+
+template <typename T>
+inline void prefetchWrite(T* ptr) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(ptr, 1);
+#endif
+}
+}  // namespace
+
 void Unstructured::to_local(const std::vector<double>& global, std::vector<double>& local) const {
-    local.resize(0);
-    std::for_each(begin(definition_), end(definition_),
-                  [&](int32_t id) { local.push_back(global[id]); });
+    const auto size = definition_.size();
+    local.resize(size);
+
+    const auto idx = definition_.data();
+    const auto git = global.data();
+    auto lit = local.data();
+    for (size_t k = 0; k != size; ++k) {
+        if (k + prefetchDistance < size) {
+            prefetchRead(git + idx[k + prefetchDistance]);
+        }
+        lit[k] = git[idx[k]];
+    }
 }
 
-void Unstructured::to_global(const message::Message& local, message::Message& global) const {
-    ASSERT(local.payload().size() == definition_.size() * sizeof(double));
+namespace {
+template <typename T>
+void scatterUnstructured(const std::vector<int32_t>& definition, const message::Message& local,
+                         message::Message& global) {
+    ASSERT(local.payload().size() == definition.size() * sizeof(T));
+
+    const auto size = definition.size();
+    const auto idx = definition.data();
+    auto lit = static_cast<const T*>(local.payload().data());
+    auto git = static_cast<T*>(global.payload().data());
+    for (size_t k = 0; k != size; ++k) {
+        if (k + prefetchDistance < size) {
+            prefetchWrite(git + idx[k + prefetchDistance]);
+        }
+        git[idx[k]] = lit[k];
+    }
+}
+}  // namespace
 
-    auto lit = static_cast<const double*>(local.payload().data());
-    auto git = static_cast<double*>(global.payload().data());
-    for (auto id : definition_) {
-        *(git + id) = *lit++;
+void Unstructured::to_global(const message::Message& local, message::Message& global) const {
+    switch (local.precision()) {
+        case message::Message::Precision::Single:
+            scatterUnstructured<float>(definition_, local, global);
+            return;
+        case message::Message::Precision::Double:
+            scatterUnstructured<double>(definition_, local, global);
+            return;
+        default:
+            NOTIMP;
     }
 }
 
-void Unstructured::to_bitmask(const message::Message&, std::vector<bool>&) const {
-    NOTIMP;
+void Unstructured::to_bitmask(const message::Message& local, std::vector<bool>& bmask) const {
+    ASSERT(static_cast<long>(bmask.size()) == global_size_);
+
+    // One byte per point, as written by multio_write_mask
+    if (local.size() != definition_.size()) {
+        throw eckit::SeriousBug{"Mismatch between sizes of index map and local mask", Here()};
+    }
+
+    auto lit = static_cast<const uint8_t*>(local.payload().data());
+    for (auto id : definition_) {
+        bmask[id] = (*lit++ != 0);
+    }
 }
 
 long Unstructured::local_size() const {
@@ -43,14 +108,14 @@ long Unstructured::global_size() const {
     return global_size_;
 }
 
-void Unstructured::collectIndices(const message::Message& local, std::set<int32_t>& glIndices) const {
-    auto payloadSize = static_cast<long>(local.payload().size() / sizeof(double));
+void Unstructured::collectIndices(const message::Message& local, IndexCoverage& coverage) const {
+    auto payloadSize = static_cast<long>(local.fieldSize());
     if (payloadSize != local_size()) {
         throw eckit::SeriousBug{"Mismatch between sizes of index map and local field", Here()};
     }
 
-    for(const auto& idx : definition_) {
-        glIndices.insert(idx);
+    for (const auto& idx : definition_) {
+        coverage.insert(idx);
     }
 }
 
@@ -72,35 +137,38 @@ void Structured::to_local(const std::vector<double>&, std::vector<double>&) cons
     NOTIMP;
 }
 
-void Structured::to_global(const message::Message& local, message::Message& global) const {
+namespace {
+template <typename T>
+void scatterStructured(const std::vector<int32_t>& definition, const message::Message& local,
+                       message::Message& global) {
 
     // Global domain's dimenstions
-    auto ni_global = definition_[0];
-    auto nj_global = definition_[1];
+    auto ni_global = definition[0];
+    auto nj_global = definition[1];
 
     // Local domain's dimensions
-    auto ibegin = definition_[2];
-    auto ni = definition_[3];
-    auto jbegin = definition_[4];
-    auto nj = definition_[5];
+    auto ibegin = definition[2];
+    auto ni = definition[3];
+    auto jbegin = definition[4];
+    auto nj = definition[5];
 
     // Data dimensions on local domain -- includes halo points
-    auto data_ibegin = definition_[7];
-    auto data_ni = definition_[8];
-    auto data_jbegin = definition_[9];
-    auto data_nj = definition_[10];
-    // auto data_dim = definition_[6]; -- Unused here
+    auto data_ibegin = definition[7];
+    auto data_ni = definition[8];
+    auto data_jbegin = definition[9];
+    auto data_nj = definition[10];
+    // auto data_dim = definition[6]; -- Unused here
 
-    ASSERT(sizeof(double) * ni_global * nj_global == global.size());
+    ASSERT(sizeof(T) * ni_global * nj_global == global.size());
 
-    if (sizeof(double) * data_ni * data_nj != local.size()) {
-        throw eckit::AssertionFailed("Local size is " + std::to_string(local.payload().size() / sizeof(double))
+    if (sizeof(T) * data_ni * data_nj != local.size()) {
+        throw eckit::AssertionFailed("Local size is " + std::to_string(local.payload().size() / sizeof(T))
                                      + " while it is expected to equal " + std::to_string(data_ni) + " times "
                                      + std::to_string(data_nj));
     }
 
-    auto lit = static_cast<const double*>(local.payload().data());
-    auto git = static_cast<double*>(global.payload().data());
+    auto lit = static_cast<const T*>(local.payload().data());
+    auto git = static_cast<T*>(global.payload().data());
     for (auto j = data_jbegin; j != data_jbegin + data_nj; ++j) {
         for (auto i = data_ibegin; i != data_ibegin + data_ni; ++i, ++lit) {
             if (inRange(i, 0, ni) && inRange(j, 0, nj)) {
@@ -110,6 +178,20 @@ void Structured::to_global(const message::Message& local, message::Message& glob
         }
     }
 }
+}  // namespace
+
+void Structured::to_global(const message::Message& local, message::Message& global) const {
+    switch (local.precision()) {
+        case message::Message::Precision::Single:
+            scatterStructured<float>(definition_, local, global);
+            return;
+        case message::Message::Precision::Double:
+            scatterStructured<double>(definition_, local, global);
+            return;
+        default:
+            NOTIMP;
+    }
+}
 
 void Structured::to_bitmask(const message::Message& local, std::vector<bool>& bmask) const {
 
@@ -143,7 +225,7 @@ void Structured::to_bitmask(const message::Message& local, std::vector<bool>& bm
 }
 
 
-void Structured::collectIndices(const message::Message& local, std::set<int32_t>& glIndices) const {
+void Structured::collectIndices(const message::Message& local, IndexCoverage& coverage) const {
 
     // Global domain's dimenstions
     auto ni_global = definition_[0];
@@ -162,21 +244,25 @@ void Structured::collectIndices(const message::Message& local, std::set<int32_t>
     auto data_nj = definition_[10];
     // auto data_dim = definition_[6]; -- Unused here
 
-    ASSERT(glIndices.size() < static_cast<std::set<int32_t>::size_type>(ni_global * nj_global));
+    ASSERT(coverage.size() == static_cast<size_t>(ni_global) * nj_global);
 
-    auto payloadSize = static_cast<long>(local.payload().size() / sizeof(double));
+    auto payloadSize = static_cast<long>(local.fieldSize());
     if (payloadSize != data_ni * data_nj) { // Payload contains halo informat$ion
         throw eckit::SeriousBug{"Mismatch between sizes of index map and local field", Here()};
     }
 
-    auto lit = static_cast<const double*>(local.payload().data());
-    for (auto j = data_jbegin; j != data_jbegin + data_nj; ++j) {
-        for (auto i = data_ibegin; i != data_ibegin + data_ni; ++i, ++lit) {
-            if (inRange(i, 0, ni) && inRange(j, 0, nj)) {
-                auto gidx = (jbegin + j) * ni_global + (ibegin + i);
-                ASSERT(glIndices.find(gidx) == std::end(glIndices));
-                glIndices.insert(gidx);
-            }
+    // Inner points of each row are contiguous in the global domain
+    auto ifirst = std::max(data_ibegin, 0);
+    auto ilast = std::min(data_ibegin + data_ni, ni);
+    if (ifirst >= ilast) {
+        return;
+    }
+    for (auto j = std::max(data_jbegin, 0); j < std::min(data_jbegin + data_nj, nj); ++j) {
+        auto rowOffset = static_cast<size_t>(jbegin + j) * ni_global + ibegin;
+        if (not coverage.insertRange(rowOffset + ifirst, rowOffset + ilast)) {
+            std::ostringstream oss;
+            oss << "Partial domain from " << local.source() << " overlaps with another one in row " << (jbegin + j);
+            throw eckit::SeriousBug{oss.str(), Here()};
         }
     }
 }
@@ -200,29 +286,97 @@ long Structured::global_size() const {
 
 //------------------------------------------------------------------------------------------------------------
 
-Spectral::Spectral(std::vector<int32_t>&& def) : Domain{std::move(def)} {}
+namespace {
+// Number of real values (real and imaginary parts) for zonal wavenumbers below m
+size_t spectralOffset(long truncation, long m) {
+    return static_cast<size_t>(m * (2 * truncation + 3 - m));
+}
+}  // namespace
 
-void Spectral::to_local(const std::vector<double>&, std::vector<double>&) const {
-    NOTIMP;
+Spectral::Spectral(std::vector<int32_t>&& def) : Domain{std::move(def)}, local_size_{0} {
+    ASSERT(not definition_.empty());
+
+    truncation_ = definition_[0];
+    ASSERT(truncation_ >= 0);
+
+    size_t localOffset = 0;
+    for (auto it = definition_.begin() + 1; it != definition_.end(); ++it) {
+        auto m = *it;
+        if (not inRange(m, 0, truncation_ + 1)) {
+            std::ostringstream oss;
+            oss << "Zonal wavenumber " << m << " is out of range for truncation " << truncation_;
+            throw eckit::UserError{oss.str(), Here()};
+        }
+
+        auto size = static_cast<size_t>(2 * (truncation_ - m + 1));
+        blocks_.push_back(Block{localOffset, spectralOffset(truncation_, m), size});
+        localOffset += size;
+    }
+    local_size_ = static_cast<long>(localOffset);
 }
 
-void Spectral::to_global(const message::Message&, message::Message&) const {
-    NOTIMP;
+void Spectral::to_local(const std::vector<double>& global, std::vector<double>& local) const {
+    ASSERT(static_cast<long>(global.size()) == global_size());
+
+    local.resize(local_size_);
+    for (const auto& block : blocks_) {
+        std::copy_n(global.begin() + block.globalOffset, block.size, local.begin() + block.localOffset);
+    }
+}
+
+namespace {
+template <typename T>
+void scatterSpectral(const std::vector<Spectral::Block>& blocks, long localSize, const message::Message& local,
+                     message::Message& global) {
+    ASSERT(local.payload().size() == localSize * sizeof(T));
+
+    auto lit = static_cast<const T*>(local.payload().data());
+    auto git = static_cast<T*>(global.payload().data());
+    for (const auto& block : blocks) {
+        std::memcpy(git + block.globalOffset, lit + block.localOffset, block.size * sizeof(T));
+    }
+}
+}  // namespace
+
+void Spectral::to_global(const message::Message& local, message::Message& global) const {
+    switch (local.precision()) {
+        case message::Message::Precision::Single:
+            scatterSpectral<float>(blocks_, local_size_, local, global);
+            return;
+        case message::Message::Precision::Double:
+            scatterSpectral<double>(blocks_, local_size_, local, global);
+            return;
+        default:
+            NOTIMP;
+    }
 }
 
 void Spectral::to_bitmask(const message::Message&, std::vector<bool>&) const {
-    NOTIMP;
+    throw eckit::UserError{"Masks are not defined for spectral domains", Here()};
 }
 
 long Spectral::local_size() const {
-    NOTIMP;
+    return local_size_;
 };
 long Spectral::global_size() const {
-    NOTIMP;
+    return (truncation_ + 1) * (truncation_ + 2);
 };
 
-void Spectral::collectIndices(const message::Message&, std::set<int32_t>&) const {
-    NOTIMP;
+void Spectral::collectIndices(const message::Message& local, IndexCoverage& coverage) const {
+    ASSERT(static_cast<long>(coverage.size()) == global_size());
+
+    auto payloadSize = static_cast<long>(local.fieldSize());
+    if (payloadSize != local_size_) {
+        throw eckit::SeriousBug{"Mismatch between sizes of spectral domain and local field", Here()};
+    }
+
+    for (const auto& block : blocks_) {
+        if (not coverage.insertRange(block.globalOffset, block.globalOffset + block.size)) {
+            std::ostringstream oss;
+            oss << "Partial domain from " << local.source() << " contains a zonal wavenumber held by another one";
+            throw eckit::SeriousBug{oss.str(), Here()};
+        }
+    }
 }
 
 }  // namespace domain
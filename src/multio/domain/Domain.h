@@ -5,7 +5,6 @@
 #include <cstddef>
 #include <cstdint>
 #include <vector>
-#include <set>
 
 #include <eckit/io/Buffer.h>
 
@@ -17,6 +16,8 @@ class Message;
 
 namespace domain {
 
+class IndexCoverage;
+
 class Domain {
 public:
     Domain(std::vector<int32_t>&& def);
@@ -29,7 +30,7 @@ public:
     virtual long local_size() const = 0;
     virtual long global_size() const = 0;
 
-    virtual void collectIndices(const message::Message& local, std::set<int32_t>& glIndices) const = 0;
+    virtual void collectIndices(const message::Message& local, IndexCoverage& coverage) const = 0;
 
 protected:
     const std::vector<int32_t> definition_;  // Grid-point
@@ -47,7 +48,7 @@ private:
     long local_size() const override;
     long global_size() const override;
     
-    void collectIndices(const message::Message& local, std::set<int32_t>& glIndices) const override;
+    void collectIndices(const message::Message& local, IndexCoverage& coverage) const override;
 
     long global_size_;
 };
@@ -64,13 +65,25 @@ private:
     long local_size() const override;
     long global_size() const override;
 
-    void collectIndices(const message::Message& local, std::set<int32_t>& glIndices) const override;
+    void collectIndices(const message::Message& local, IndexCoverage& coverage) const override;
 };
 
+// Spherical-harmonic coefficients in triangular truncation, distributed by zonal wavenumber. The
+// definition is the truncation T followed by the zonal wavenumbers m held by the partial domain. The
+// global field is ordered by m and then by total wavenumber n = m, ..., T, with the real and imaginary
+// parts of each coefficient adjacent. The partial field holds the coefficients of its wavenumbers in
+// the order they are listed.
 class Spectral final : public Domain {
 public:
     Spectral(std::vector<int32_t>&& def);
 
+    // Contiguous run of values belonging to one zonal wavenumber
+    struct Block {
+        size_t localOffset;
+        size_t globalOffset;
+        size_t size;
+    };
+
 private:
     void to_local(const std::vector<double>& global, std::vector<double>& local) const override;
     void to_global(const message::Message& local, message::Message& global) const override;
@@ -79,7 +92,11 @@ private:
     long local_size() const override;
     long global_size() const override;
 
-    void collectIndices(const message::Message& local, std::set<int32_t>& glIndices) const override;
+    void collectIndices(const message::Message& local, IndexCoverage& coverage) const override;
+
+    long truncation_;
+    std::vector<Block> blocks_;
+    long local_size_;
 };
 
 }  // namespace domain
@@ -0,0 +1,84 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "IndexCoverage.h"
+
+#include <bitset>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace multio {
+namespace domain {
+
+namespace {
+const size_t wordBits = 64;
+
+uint64_t lowBits(size_t n) {
+    return (n == wordBits) ? ~uint64_t{0} : ((uint64_t{1} << n) - 1);
+}
+}  // namespace
+
+IndexCoverage::IndexCoverage(size_t size) :
+    size_{size}, wordCount_{(size + wordBits - 1) / wordBits}, words_{new std::atomic<uint64_t>[wordCount_]} {
+    for (size_t i = 0; i != wordCount_; ++i) {
+        words_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool IndexCoverage::setBits(size_t word, uint64_t bits) {
+    auto previous = words_[word].fetch_or(bits, std::memory_order_relaxed);
+    return (previous & bits) == 0;
+}
+
+bool IndexCoverage::insert(size_t idx) {
+    if (idx >= size_) {
+        throw eckit::OutOfRange(idx, size_, Here());
+    }
+    return setBits(idx / wordBits, uint64_t{1} << (idx % wordBits));
+}
+
+bool IndexCoverage::insertRange(size_t first, size_t last) {
+    if (first >= last) {
+        return true;
+    }
+    if (last > size_) {
+        throw eckit::OutOfRange(last - 1, size_, Here());
+    }
+
+    auto firstWord = first / wordBits;
+    auto lastWord = (last - 1) / wordBits;
+    auto firstMask = ~lowBits(first % wordBits);
+    auto lastMask = lowBits((last - 1) % wordBits + 1);
+
+    if (firstWord == lastWord) {
+        return setBits(firstWord, firstMask & lastMask);
+    }
+
+    bool disjoint = setBits(firstWord, firstMask);
+    for (auto word = firstWord + 1; word != lastWord; ++word) {
+        disjoint = setBits(word, ~uint64_t{0}) && disjoint;
+    }
+    return setBits(lastWord, lastMask) && disjoint;
+}
+
+size_t IndexCoverage::size() const {
+    return size_;
+}
+
+size_t IndexCoverage::count() const {
+    size_t total = 0;
+    for (size_t i = 0; i != wordCount_; ++i) {
+        total += std::bitset<wordBits>(words_[i].load(std::memory_order_relaxed)).count();
+    }
+    return total;
+}
+
+}  // namespace domain
+}  // namespace multio
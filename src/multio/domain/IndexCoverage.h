@@ -0,0 +1,51 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2022
+
+#ifndef multio_domain_IndexCoverage_H
+#define multio_domain_IndexCoverage_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace multio {
+namespace domain {
+
+// Dense bitmap recording which global indices are covered by the partial domains. Insertions are
+// atomic, so partial domains may be collected concurrently.
+class IndexCoverage {
+public:
+    explicit IndexCoverage(size_t size);
+
+    IndexCoverage(const IndexCoverage&) = delete;
+    IndexCoverage& operator=(const IndexCoverage&) = delete;
+
+    // Return false if (any of) the index had already been covered
+    bool insert(size_t idx);
+    bool insertRange(size_t first, size_t last);
+
+    size_t size() const;
+    size_t count() const;
+
+private:
+    bool setBits(size_t word, uint64_t bits);
+
+    size_t size_;
+    size_t wordCount_;
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+};
+
+}  // namespace domain
+}  // namespace multio
+
+#endif
@@ -2,11 +2,15 @@
 #include "Mappings.h"
 
 #include <cstring>
+#include <exception>
+#include <thread>
 
+#include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/Buffer.h"
 
 #include "multio/LibMultio.h"
+#include "multio/domain/IndexCoverage.h"
 #include "multio/message/Message.h"
 #include "multio/util/print_buffer.h"
 
@@ -52,6 +56,11 @@ void Mappings::add(message::Message msg) {
         return;
     }
 
+    if (msg.metadata().getString("representation") == "spectral") {
+        domainMap.emplace(msg.source(), std::unique_ptr<Domain>{new Spectral{std::move(local_map)}});
+        return;
+    }
+
     throw eckit::AssertionFailed("Unsupported domain representation " +
                                  msg.metadata().getString("representation"));
 }
@@ -80,15 +89,54 @@ void Mappings::checkDomainConsistency(const std::vector<message::Message>& local
         return;
     }
 
-    std::set<int32_t> globalIndices;
+    std::vector<const Domain*> domains;
     for (const auto& local : localDomains) {
-        get(local.domain()).at(local.source())->collectIndices(local, globalIndices);
+        domains.push_back(get(local.domain()).at(local.source()).get());
+    }
+
+    auto globalSize = static_cast<size_t>(localDomains.back().globalSize());
+    IndexCoverage coverage{globalSize};
+
+    // Partial domains are disjoint, so they may be collected concurrently into the same bitmap
+    static const auto threadCount = eckit::Resource<size_t>("multioDomainCheckThreads;$MULTIO_DOMAIN_CHECK_THREADS", 1);
+    auto nThreads = std::min(std::max<size_t>(threadCount, 1), localDomains.size());
+
+    auto collect = [&](size_t first, size_t stride) {
+        for (auto ii = first; ii < localDomains.size(); ii += stride) {
+            domains[ii]->collectIndices(localDomains[ii], coverage);
+        }
+    };
+
+    if (nThreads == 1) {
+        collect(0, 1);
+    }
+    else {
+        std::vector<std::exception_ptr> errors(nThreads);
+        std::vector<std::thread> workers;
+        for (size_t tid = 0; tid != nThreads; ++tid) {
+            workers.emplace_back([&, tid]() {
+                try {
+                    collect(tid, nThreads);
+                }
+                catch (...) {
+                    errors[tid] = std::current_exception();
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
     }
 
-    auto globalSize = static_cast<std::set<int32_t>::size_type>(localDomains.back().globalSize());
-    if (globalIndices.size() != globalSize) {
+    auto covered = coverage.count();
+    if (covered != globalSize) {
         std::ostringstream oss;
-        oss << "Number of inserted unique indices: " << globalIndices.size() << " (expected " << globalSize << ")";
+        oss << "Number of inserted unique indices: " << covered << " (expected " << globalSize << ")";
         throw eckit::SeriousBug{oss.str(), Here()};
     }
 
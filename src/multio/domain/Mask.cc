@@ -17,6 +17,7 @@
 
 #include "multio/domain/Mappings.h"
 #include "multio/message/Message.h"
+#include "multio/util/MemoryAccount.h"
 
 namespace multio {
 namespace domain {
@@ -40,12 +41,15 @@ void Mask::add(message::Message msg) {
     }
 }
 
-const std::vector<bool>& Mask::get(const std::string& bkey) const {
-    if (bitmasks_.find(bkey) == std::end(bitmasks_)) {
+std::shared_ptr<const Bitmask> Mask::get(const std::string& bkey) const {
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    auto it = bitmasks_.find(bkey);
+    if (it == std::end(bitmasks_)) {
         throw eckit::AssertionFailed("There is no bitmask for " + bkey);
     }
 
-    return bitmasks_.at(bkey);
+    return it->second;
 }
 
 void Mask::addPartialMask(message::Message msg) {
@@ -53,6 +57,7 @@ void Mask::addPartialMask(message::Message msg) {
 
     auto& msgList = messages_[msg.fieldId()];
 
+    util::MemoryAccount::get("mask").add(msg.size());
     msgList.push_back(std::move(msg));
 }
 
@@ -74,9 +79,21 @@ void Mask::createBitmask(message::Message inMsg) {
 
     // Assert invariants such are bound to be creating this the first and last time
     auto bkey = Mask::key(inMsg.metadata());
-    bitmasks_[bkey] = std::move(bitmask);
+    auto& account = util::MemoryAccount::get("mask");
+    auto& entry = bitmasks_[bkey];
+    if (entry) {
+        account.remove(entry->words().size() * sizeof(uint64_t));
+    }
+    entry = std::make_shared<const Bitmask>(bitmask);
+    account.add(entry->words().size() * sizeof(uint64_t));
 
-    messages_.at(inMsg.fieldId()).clear();
+    auto& parts = messages_.at(inMsg.fieldId());
+    size_t bytes = 0;
+    for (const auto& msg : parts) {
+        bytes += msg.size();
+    }
+    account.remove(bytes, parts.size());
+    parts.clear();
 }
 
 }  // namespace domain
@@ -5,11 +5,14 @@
 #include <cstddef>
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
 #include <eckit/io/Buffer.h>
 
+#include "multio/domain/Bitmask.h"
+
 namespace eckit {
 class LocalConfiguration;
 }
@@ -39,7 +42,8 @@ public:
 
     void add(message::Message msg);
 
-    const std::vector<bool>& get(const std::string& name) const;
+    // Masks are shared by all plans (and actions) referring to the same (domain, level)
+    std::shared_ptr<const Bitmask> get(const std::string& name) const;
 
 private:
 
@@ -49,7 +53,7 @@ private:
     void createBitmask(message::Message msg);
 
     std::map<std::string, std::vector<message::Message>> messages_;
-    std::map<std::string, std::vector<bool>> bitmasks_;
+    std::map<std::string, std::shared_ptr<const Bitmask>> bitmasks_;
 
     mutable std::mutex mutex_;
 };
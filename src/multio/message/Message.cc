@@ -39,13 +39,54 @@ std::string Message::tag2str(Tag t) {
                                            {Tag::Mask, "Mask"},
                                            {Tag::Field, "Field"},
                                            {Tag::StepComplete, "StepComplete"},
-                                           {Tag::StepNotification, "StepNotification"}};
+                                           {Tag::StepNotification, "StepNotification"},
+                                           {Tag::Credit, "Credit"}};
 
     ASSERT(t < Tag::ENDTAG);
 
     return m.find(t)->second;
 }
 
+bool Message::isControl(Tag t) {
+    switch (t) {
+        case Tag::Domain:
+        case Tag::Mask:
+        case Tag::StepComplete:
+        case Tag::StepNotification:
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t Message::sizeOf(Precision p) {
+    switch (p) {
+        case Precision::Single:
+            return sizeof(float);
+        case Precision::Double:
+            return sizeof(double);
+        default:
+            NOTIMP;
+    }
+}
+
+Message::BorrowedPayload::BorrowedPayload(const void* data, size_t size, std::function<void()> release) :
+    data_{data}, size_{size}, release_{std::move(release)} {}
+
+Message::BorrowedPayload::~BorrowedPayload() {
+    if (release_) {
+        release_();
+    }
+}
+
+const void* Message::BorrowedPayload::data() const {
+    return data_;
+}
+
+size_t Message::BorrowedPayload::size() const {
+    return size_;
+}
+
 Message::Message() : Message(Message::Header{Message::Tag::Empty, Peer{}, Peer{}}) {}
 
 Message::Message(Header&& header, const eckit::Buffer& payload) :
@@ -63,6 +104,11 @@ Message::Message(std::shared_ptr<Header>&& header, std::shared_ptr<eckit::Buffer
 Message::Message(std::shared_ptr<Header>&& header, const std::shared_ptr<eckit::Buffer>& payload) :
     version_{protocolVersion()}, header_{std::move(header)}, payload_{payload} {}
 
+Message::Message(Header&& header, std::shared_ptr<BorrowedPayload> borrowed) :
+    version_{protocolVersion()}, header_{std::make_shared<Header>(std::move(header))}, borrowed_{std::move(borrowed)} {
+    ASSERT(borrowed_);
+}
+
 const Message::Header& Message::header() const {
     return *header_;
 }
@@ -99,6 +145,14 @@ std::string Message::domain() const {
     return header().domain();
 }
 
+Message::Precision Message::precision() const {
+    return header().precision();
+}
+
+size_t Message::fieldSize() const {
+    return size() / sizeOf(precision());
+}
+
 const std::string& Message::fieldId() const {
     return header().fieldId();
 }
@@ -112,19 +166,62 @@ const Metadata& Message::metadata() const& {
 // }
     
 Message Message::modifyMetadata(Metadata&& md) const {
-    return Message(std::make_shared<Header>(header_->modifyMetadata(std::move(md))), payload_);
+    return modifyHeader(header_->modifyMetadata(std::move(md)));
 };
 
+void Message::setTrace(uint64_t id, int64_t timestamp) {
+    header_->setTrace(id, timestamp);
+}
+
+Message Message::modifyHeader(Header&& header) const {
+    Message msg = borrowed_ ? Message(std::move(header), borrowed_)
+                            : Message(std::make_shared<Header>(std::move(header)), payload_);
+    msg.shared_ = shared_;
+    return msg;
+}
+
+Message Message::share() const {
+    Message msg{*this};
+    msg.shared_ = true;
+    shared_ = true;
+    return msg;
+}
+
+Message Message::withoutPayload() const {
+    static const auto empty = std::make_shared<eckit::Buffer>(0);
+    return Message{std::shared_ptr<Header>{header_}, empty};
+}
+
+void Message::materialisePayload() const {
+    if (borrowed_) {
+        payload_ = std::make_shared<eckit::Buffer>(static_cast<const char*>(borrowed_->data()), borrowed_->size());
+        borrowed_.reset();
+    }
+}
+
 eckit::Buffer& Message::payload() {
+    // Materialising a borrowed payload already yields a private copy, and a payload whose other sharers have
+    // gone is private already
+    auto detach = shared_ && not borrowed_ && payload_.use_count() > 1;
+    materialisePayload();
+    shared_ = false;
+    if (detach) {
+        payload_ = std::make_shared<eckit::Buffer>(static_cast<const char*>(payload_->data()), payload_->size());
+    }
     return *payload_;
 }
 
 const eckit::Buffer& Message::payload() const {
+    materialisePayload();
     return *payload_;
 }
 
 size_t Message::size() const {
-    return payload_->size();
+    return borrowed_ ? borrowed_->size() : payload_->size();
+}
+
+bool Message::isBorrowed() const {
+    return static_cast<bool>(borrowed_);
 }
 
 void Message::encode(eckit::Stream& strm) const {
@@ -132,6 +229,12 @@ void Message::encode(eckit::Stream& strm) const {
 
     strm << size();
 
+    if (borrowed_) {
+        // Same wire format as streaming an eckit::Buffer, straight from the caller's memory
+        strm.writeBlob(borrowed_->data(), borrowed_->size());
+        return;
+    }
+
     strm << payload();
 }
 
@@ -139,7 +242,7 @@ void Message::print(std::ostream& out) const {
     out << "Message("
         << "version=" << version() << ", tag=" << tag2str(tag()) << ", source=" << source()
         << ", destination=" << destination() << ", metadata=" << fieldId()
-        << ", payload-size=" << payload().size() << ")";
+        << ", payload-size=" << size() << ")";
 }
 
 eckit::message::Message to_eckit_message(const Message& msg) {
@@ -17,6 +17,8 @@
 #ifndef multio_server_Message_H
 #define multio_server_Message_H
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -52,9 +54,17 @@ public:  // types
         Field,
         StepComplete,
         StepNotification,
+        Credit,
         ENDTAG
     };
 
+    // Floating-point precision of field payloads, recorded as "precision" in the metadata
+    enum class Precision : unsigned
+    {
+        Single = 0,
+        Double
+    };
+
     class Header {
     public:
         Header(Tag tag, Peer src, Peer dst, std::string&& fieldId);
@@ -73,6 +83,8 @@ public:  // types
 
         std::string domain() const;
 
+        Precision precision() const;
+
         const std::string& fieldId() const;
 
         void encode(eckit::Stream& strm) const;
@@ -82,6 +94,15 @@ public:  // types
         
         Header modifyMetadata(Metadata&& md) const;
 
+        // Set by the client when tracing is enabled (see util/Tracing.h), zero otherwise. The timestamp
+        // (microseconds since the epoch) records when the message was handed on by the client and,
+        // once received, when the server queued it for dispatching.
+        uint64_t traceId() const;
+        int64_t traceTimestamp() const;
+
+        // Sets the trace of the header, which is shared by all copies of this message
+        void setTrace(uint64_t id, int64_t timestamp);
+
     private:
         Tag tag_;
 
@@ -91,6 +112,29 @@ public:  // types
         Metadata metadata_;
         // encode fieldId_ lazily
         mutable eckit::Optional<std::string> fieldId_; // Make that a hash?
+
+        uint64_t traceId_ = 0;
+        int64_t traceTimestamp_ = 0;
+    };
+
+    // Caller-owned memory that is referenced instead of copied into the message. The release callback
+    // is invoked once no message refers to the memory any more, i.e. once every message sharing it has
+    // been serialised, copied into an owned payload or destroyed.
+    class BorrowedPayload {
+    public:
+        BorrowedPayload(const void* data, size_t size, std::function<void()> release);
+        ~BorrowedPayload();
+
+        BorrowedPayload(const BorrowedPayload&) = delete;
+        BorrowedPayload& operator=(const BorrowedPayload&) = delete;
+
+        const void* data() const;
+        size_t size() const;
+
+    private:
+        const void* data_;
+        size_t size_;
+        std::function<void()> release_;
     };
 
     // class Content {
@@ -113,12 +157,18 @@ public:  // types
 public:  // methods
     static int protocolVersion();
     static std::string tag2str(Tag t);
+    static size_t sizeOf(Precision p);
+
+    // Small messages that steer the processing of fields. They are passed on ahead of bulk field data
+    // wherever that keeps the order of the messages from each client.
+    static bool isControl(Tag t);
 
     Message();
     Message(Header&& header, const eckit::Buffer& payload = eckit::Buffer{0});
     Message(Header&& header, eckit::Buffer&& payload);
     Message(std::shared_ptr<Header>&& header, std::shared_ptr<eckit::Buffer>&& payload);
     Message(std::shared_ptr<Header>&& header, const std::shared_ptr<eckit::Buffer>& payload);
+    Message(Header&& header, std::shared_ptr<BorrowedPayload> borrowed);
     // Message(std::shared_ptr<Header> header, std::shared_ptr<eckit::Buffer> payload);
 
 public:
@@ -139,6 +189,11 @@ public:
 
     std::string domain() const;
 
+    Precision precision() const;
+
+    // Number of field values in the payload, given its precision
+    size_t fieldSize() const;
+
     const std::string& fieldId() const;
     
     // Metadata&& metadata() &&;
@@ -147,11 +202,30 @@ public:
     
     Message modifyMetadata(Metadata&& md) const;
 
+    void setTrace(uint64_t id, int64_t timestamp);
+
+    // Replaces the header but shares the payload, borrowed or not
+    Message modifyHeader(Header&& header) const;
+
+    // Copy for another consumer of the same payload, e.g. another branch of a plan. The payload is
+    // shared until either copy modifies it through payload(), which then works on a private copy.
+    Message share() const;
+
+    // Same header without the payload, e.g. to describe the message once its payload has been passed on
+    Message withoutPayload() const;
+
+    // Accessing the payload of a borrowed message copies it into an owned buffer
     eckit::Buffer& payload();
     const eckit::Buffer& payload() const;
 
     size_t size() const;
 
+    bool isBorrowed() const;
+
+    // Copies a borrowed payload into an owned buffer. Actions that keep messages beyond the call that passed them
+    // on must do so, as the caller waits for borrowed memory to be released.
+    void materialisePayload() const;
+
     void encode(eckit::Stream& strm) const;
 
 private:  // methods
@@ -166,7 +240,9 @@ private:  // members
     int version_;
 
     std::shared_ptr<Header> header_;
-    std::shared_ptr<eckit::Buffer> payload_;
+    mutable std::shared_ptr<eckit::Buffer> payload_;
+    mutable std::shared_ptr<BorrowedPayload> borrowed_;
+    mutable bool shared_ = false;
 
 };
 
@@ -11,6 +11,7 @@
 #include "Message.h"
 
 #include "eckit/config/YAMLConfiguration.h"
+#include "eckit/exception/Exceptions.h"
 #include "eckit/serialisation/Stream.h"
 
 namespace multio {
@@ -66,6 +67,21 @@ std::string Message::Header::domain() const {
     return metadata_.getString("domain");
 }
 
+Message::Precision Message::Header::precision() const {
+    if (!metadata_.has("precision")) {
+        return Precision::Double;
+    }
+
+    const auto prec = metadata_.getString("precision");
+    if (prec == "double") {
+        return Precision::Double;
+    }
+    if (prec == "single") {
+        return Precision::Single;
+    }
+    throw eckit::BadValue("Unsupported precision " + prec, Here());
+}
+
 const std::string& Message::Header::fieldId() const {
     if (!fieldId_) {
         fieldId_ = message::to_string(metadata_);
@@ -83,12 +99,30 @@ void Message::Header::encode(eckit::Stream& strm) const {
     strm << destination_.id();
 
     strm << fieldId();
+
+    strm << static_cast<unsigned long long>(traceId_);
+    strm << static_cast<long long>(traceTimestamp_);
 }
 
 Message::Header Message::Header::modifyMetadata(Metadata&& md) const {
-    return Header{tag_, std::move(source_), std::move(destination_), std::move(md)};
+    Header header{tag_, std::move(source_), std::move(destination_), std::move(md)};
+    header.setTrace(traceId_, traceTimestamp_);
+    return header;
 };
 
+uint64_t Message::Header::traceId() const {
+    return traceId_;
+}
+
+int64_t Message::Header::traceTimestamp() const {
+    return traceTimestamp_;
+}
+
+void Message::Header::setTrace(uint64_t id, int64_t timestamp) {
+    traceId_ = id;
+    traceTimestamp_ = timestamp;
+}
+
 
 }  // namespace message
 }  // namespace multio
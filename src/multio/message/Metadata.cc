@@ -4,7 +4,9 @@
 #include <sstream>
 
 #include "eckit/config/YAMLConfiguration.h"
+#include "eckit/exception/Exceptions.h"
 #include "eckit/log/JSON.h"
+#include "eckit/value/Value.h"
 
 namespace multio {
 namespace message {
@@ -24,5 +26,59 @@ Metadata to_metadata(const std::string& fieldId) {
     return Metadata{config};
 }
 
+namespace {
+std::string floatingPointString(double value) {
+    std::ostringstream oss;
+    oss.precision(17);
+    oss << value;
+    return oss.str();
+}
+}  // namespace
+
+std::string to_string(const eckit::Configuration& config, const std::string& key) {
+    if (config.isString(key)) {
+        return config.getString(key);
+    }
+    if (config.isIntegral(key)) {
+        return std::to_string(config.getLong(key));
+    }
+    if (config.isBoolean(key)) {
+        return config.getBool(key) ? "true" : "false";
+    }
+    if (config.isFloatingPoint(key)) {
+        return floatingPointString(config.getDouble(key));
+    }
+    throw eckit::UserError("Entry " + key + " does not hold a single value", Here());
+}
+
+std::vector<std::string> to_string_vector(const eckit::Configuration& config, const std::string& key) {
+    if (not config.isList(key)) {
+        return std::vector<std::string>{to_string(config, key)};
+    }
+
+    const eckit::Value list = config.get()[key];
+
+    std::vector<std::string> values;
+    for (size_t i = 0; i != list.size(); ++i) {
+        const eckit::Value item = list[static_cast<int>(i)];
+        if (item.isString()) {
+            values.push_back(static_cast<std::string>(item));
+        }
+        else if (item.isNumber()) {
+            values.push_back(std::to_string(static_cast<long long>(item)));
+        }
+        else if (item.isBool()) {
+            values.push_back(static_cast<bool>(item) ? "true" : "false");
+        }
+        else if (item.isDouble()) {
+            values.push_back(floatingPointString(static_cast<double>(item)));
+        }
+        else {
+            throw eckit::UserError("Entry " + key + " must be a list of single values", Here());
+        }
+    }
+    return values;
+}
+
 }  // namespace message
 }  // namespace multio
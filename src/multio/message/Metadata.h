@@ -17,6 +17,9 @@
 #ifndef multio_server_Metadata_H
 #define multio_server_Metadata_H
 
+#include <string>
+#include <vector>
+
 #include "eckit/config/LocalConfiguration.h"
 
 namespace multio {
@@ -31,6 +34,13 @@ public:
 std::string to_string(const Metadata& metadata);
 Metadata to_metadata(const std::string& fieldId);
 
+// Scalar value of an entry as a string, whatever its type, e.g. to compare it with configured values.
+// Integers are written without a decimal point, so that a level 1 compares equal to "1".
+std::string to_string(const eckit::Configuration& config, const std::string& key);
+
+// Values of a list entry as strings, whatever the type of its elements
+std::vector<std::string> to_string_vector(const eckit::Configuration& config, const std::string& key);
+
 }  // namespace message
 }  // namespace multio
 
@@ -19,11 +19,16 @@
 
 #include "multio/LibMultio.h"
 #include "multio/action/Plan.h"
+#include "multio/action/Router.h"
 
 #include "multio/domain/Mappings.h"
 #include "multio/domain/Mask.h"
+#include "multio/server/MessageQueue.h"
 
+#include "multio/util/MemoryAccount.h"
+#include "multio/util/Metrics.h"
 #include "multio/util/ScopedTimer.h"
+#include "multio/util/Tracing.h"
 #include "multio/util/logfile_name.h"
 
 using eckit::LocalConfiguration;
@@ -41,6 +46,7 @@ Dispatcher::Dispatcher(const util::ConfigurationContext& confCtx, std::shared_pt
         eckit::Log::debug<LibMultio>() << subCtx.config() << std::endl;
         plans_.emplace_back(new action::Plan(std::move(subCtx)));
     }
+    router_.reset(new action::Router{plans_});
 }
 
 util::FailureHandlerResponse Dispatcher::handleFailure(util::OnDispatchError t, const util::FailureContext& c, util::DefaultFailureState&) const {
@@ -52,14 +58,25 @@ Dispatcher::~Dispatcher() {
     std::ofstream logFile{util::logfile_name(), std::ios_base::app};
     logFile << "\n ** Total wall-clock time spent in dispatcher " << eckit::Timing{timer_}.elapsed_
             << "s -- of which time spent with dispatching " << timing_ << "s" << std::endl;
+    logFile << " ** Memory held by the server\n";
+    util::MemoryAccount::report(logFile);
 }
 
-void Dispatcher::dispatch(eckit::Queue<message::Message>& queue) {
+void Dispatcher::dispatch(MessageQueue& queue) {
     util::ScopedTimer timer{timing_};
+
+    // Nothing takes messages off the queue any more, so the listener must not wait for space in it
+    struct Closing {
+        MessageQueue& queue;
+        ~Closing() { queue.close(); }
+    } closing{queue};
+
     withFailureHandling([&]() {
+        auto& queueDepth = util::Metrics::instance().gauge("dispatch_queue_depth");
         message::Message msg;
         auto sz = queue.pop(msg);
         while (sz >= 0 && continue_->load(std::memory_order_consume)) {
+            queueDepth.set(sz);
             handle(msg);
             LOG_DEBUG_LIB(multio::LibMultio) << "Size of the dispatch queue: " << sz << std::endl;
             sz = queue.pop(msg);
@@ -78,7 +95,17 @@ void Dispatcher::handle(const message::Message& msg) const {
             break;
 
         default:
-            for (const auto& plan : plans_) {
+            if (util::Tracer::enabled()) {
+                auto now = util::Tracer::now();
+                const auto& header = msg.header();
+                util::Tracer::instance().complete("queue-wait", header.traceId(), header.traceTimestamp(),
+                                                  now - header.traceTimestamp());
+                if (header.traceId() != 0) {
+                    util::Tracer::instance().flowEnd(header.traceId(), now);
+                }
+            }
+            util::TraceSpan span{"dispatch", msg.header().traceId()};
+            for (const auto& plan : router_->route(msg)) {
                 plan->process(msg);
             }
     }
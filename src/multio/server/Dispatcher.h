@@ -20,7 +20,6 @@
 #include <memory>
 #include <atomic>
 
-#include "eckit/container/Queue.h"
 #include "eckit/log/Statistics.h"
 #include "eckit/memory/NonCopyable.h"
 #include "multio/util/FailureHandling.h"
@@ -37,16 +36,19 @@ namespace multio {
 
 namespace action {
 class Plan;
+class Router;
 }
 
 namespace server {
 
+class MessageQueue;
+
 class Dispatcher : public util::FailureAware<util::ComponentTag::Dispatcher>, private eckit::NonCopyable {
 public:
     Dispatcher(const util::ConfigurationContext& confCtx, std::shared_ptr<std::atomic<bool>> cont);
     ~Dispatcher();
 
-    void dispatch(eckit::Queue<message::Message>& queue);
+    void dispatch(MessageQueue& queue);
     
     util::FailureHandlerResponse handleFailure(util::OnDispatchError, const util::FailureContext&, util::DefaultFailureState&) const override;
 
@@ -56,6 +58,7 @@ private:
 
     std::shared_ptr<std::atomic<bool>> continue_;
     std::vector<std::unique_ptr<action::Plan>> plans_;
+    std::unique_ptr<action::Router> router_;
 
     eckit::Timing timing_;
     eckit::Timer timer_;
@@ -24,6 +24,7 @@
 #include "multio/message/Message.h"
 
 #include "multio/util/ScopedThread.h"
+#include "multio/util/Tracing.h"
 #include "multio/util/ConfigurationContext.h"
 #include "multio/server/Dispatcher.h"
 #include "multio/transport/Transport.h"
@@ -41,7 +42,8 @@ Listener::Listener(const util::ConfigurationContext& confCtx, Transport& trans):
     dispatcher_{std::make_shared<Dispatcher>(confCtx.recast(util::ComponentTag::Dispatcher), continue_)},
     transport_{trans},
     clientCount_{transport_.clientPeers().size()},
-    msgQueue_(eckit::Resource<size_t>("multioMessageQueueSize;$MULTIO_MESSAGE_QUEUE_SIZE",1024*1024)) {
+    msgQueue_(eckit::Resource<size_t>("multioMessageQueueSize;$MULTIO_MESSAGE_QUEUE_SIZE",1024*1024),
+              eckit::Resource<size_t>("multioMessageQueueBytes;$MULTIO_MESSAGE_QUEUE_BYTES", size_t(4) << 30)) {
 }
 
 util::FailureHandlerResponse Listener::handleFailure(util::OnReceiveError t, const util::FailureContext& c, util::DefaultFailureState&) const {
@@ -77,6 +79,7 @@ void Listener::start() {
 
                 case Message::Tag::Close:
                     connections_.erase(connections_.find(msg.source()));
+                    transport_.revokeCredit(msg.source());
                     ++closedCount_;
                     LOG_DEBUG_LIB(LibMultio)
                         << "*** CLOSING connection to " << msg.source()
@@ -91,7 +94,24 @@ void Listener::start() {
                 case Message::Tag::Field:
                     checkConnection(msg.source());
                     LOG_DEBUG_LIB(LibMultio) << "*** Message received: " << msg << std::endl;
-                    msgQueue_.emplace(std::move(msg));
+                    if (util::Tracer::enabled()) {
+                        // From the client handing the message on until now, as far as clocks agree
+                        auto now = util::Tracer::now();
+                        const auto& header = msg.header();
+                        if (header.traceTimestamp() != 0) {
+                            util::Tracer::instance().complete("transit", header.traceId(), header.traceTimestamp(),
+                                                              now - header.traceTimestamp());
+                        }
+                        msg.setTrace(header.traceId(), now);
+                    }
+                    {
+                        // Once queued, the client may send as much again
+                        auto source = msg.source();
+                        auto size = msg.size();
+                        if (msgQueue_.emplace(std::move(msg))) {
+                            transport_.grantCredit(source, size);
+                        }
+                    }
                     break;
 
                 default:
@@ -21,10 +21,9 @@
 #include <memory>
 #include <set>
 
-#include "eckit/container/Queue.h"
-
 #include "multio/message/Message.h"
 #include "multio/message/Peer.h"
+#include "multio/server/MessageQueue.h"
 #include "multio/util/ConfigurationContext.h"
 #include "multio/util/FailureHandling.h"
 
@@ -66,7 +65,7 @@ private:
 
 
     std::set<message::Peer> connections_;
-    mutable eckit::Queue<message::Message> msgQueue_; // Mark mutable to be able to close when handling failure in const function
+    mutable MessageQueue msgQueue_; // Mark mutable to be able to close when handling failure in const function
 
 };
 
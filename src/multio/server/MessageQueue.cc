@@ -0,0 +1,119 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "MessageQueue.h"
+
+#include <algorithm>
+
+#include "eckit/exception/Exceptions.h"
+
+#include "multio/util/MemoryAccount.h"
+
+namespace multio {
+namespace server {
+
+MessageQueue::MessageQueue(size_t maxMessages, size_t maxBytes) :
+    maxMessages_{maxMessages}, maxBytes_{maxBytes}, account_{util::MemoryAccount::get("listener-queue")} {
+    ASSERT(maxMessages_ > 0);
+}
+
+bool MessageQueue::emplace(message::Message&& msg) {
+    const auto size = msg.size();
+    const auto control = message::Message::isControl(msg.tag());
+
+    std::unique_lock<std::mutex> lock{mutex_};
+    notFull_.wait(lock, [&]() {
+        return closed_ || control || fields_.empty()
+            || (fields_.size() + controls_.size() < maxMessages_ && (maxBytes_ == 0 || bytes_ + size <= maxBytes_));
+    });
+    if (closed_) {
+        return false;
+    }
+
+    account_.add(size);
+    bytes_ += size;
+    const auto seq = seq_++;
+    if (control) {
+        controls_.push_back(Entry{std::move(msg), seq});
+    }
+    else {
+        sourceFields_[msg.source()].push_back(seq);
+        fields_.push_back(Entry{std::move(msg), seq});
+    }
+
+    lock.unlock();
+    notEmpty_.notify_one();
+    return true;
+}
+
+long MessageQueue::pop(message::Message& msg) {
+    std::unique_lock<std::mutex> lock{mutex_};
+    notEmpty_.wait(lock, [this]() { return closed_ || !fields_.empty() || !controls_.empty(); });
+    if (fields_.empty() && controls_.empty()) {
+        return -1;
+    }
+
+    auto control = nextControl();
+    if (control != controls_.end()) {
+        msg = std::move(control->msg);
+        controls_.erase(control);
+    }
+    else {
+        msg = std::move(fields_.front().msg);
+        fields_.pop_front();
+
+        auto it = sourceFields_.find(msg.source());
+        it->second.pop_front();
+        if (it->second.empty()) {
+            sourceFields_.erase(it);
+        }
+    }
+
+    const auto size = msg.size();
+    account_.remove(size);
+    bytes_ -= size;
+    const auto left = static_cast<long>(fields_.size() + controls_.size());
+
+    lock.unlock();
+    notFull_.notify_one();
+    return left;
+}
+
+std::deque<MessageQueue::Entry>::iterator MessageQueue::nextControl() {
+    // A control message waits for the fields queued before it from the same source. Picking the oldest field
+    // when none may go keeps the order between fields and control messages, as that field is older than
+    // all of them.
+    return std::find_if(controls_.begin(), controls_.end(), [this](const Entry& entry) {
+        auto it = sourceFields_.find(entry.msg.source());
+        return it == sourceFields_.end() || it->second.front() > entry.seq;
+    });
+}
+
+void MessageQueue::close() {
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        closed_ = true;
+    }
+    notEmpty_.notify_all();
+    notFull_.notify_all();
+}
+
+bool MessageQueue::closed() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return closed_;
+}
+
+size_t MessageQueue::bytes() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return bytes_;
+}
+
+}  // namespace server
+}  // namespace multio
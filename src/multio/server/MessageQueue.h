@@ -0,0 +1,94 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2022
+
+/// Queue of received messages waiting to be dispatched, bounded both by the number of messages and by
+/// the bytes of their payloads. A full queue blocks the listener, which stops taking messages off the
+/// transport, so that clients are slowed down instead of the server running out of memory.
+///
+/// Control messages (see Message::isControl) are held in a lane of their own, which is not subject to
+/// the bounds. A control message is handed out ahead of queued fields, unless a field from the same
+/// source was queued before it: the messages of each source leave the queue in the order they arrived.
+
+#ifndef multio_server_MessageQueue_H
+#define multio_server_MessageQueue_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+
+#include "multio/message/Message.h"
+
+namespace multio {
+
+namespace util {
+class MemoryAccount;
+}
+
+namespace server {
+
+class MessageQueue {
+public:
+    MessageQueue(size_t maxMessages, size_t maxBytes);
+
+    MessageQueue(const MessageQueue&) = delete;
+    MessageQueue& operator=(const MessageQueue&) = delete;
+
+    // Blocks while the queue is full, unless it is a control message. A message larger than the byte limit
+    // is accepted once no other field is queued. Returns false, dropping the message, if the queue is
+    // closed.
+    bool emplace(message::Message&& msg);
+
+    // Blocks until a message is available. Returns the number of messages left in the queue, or -1 once
+    // the queue is closed and empty.
+    long pop(message::Message& msg);
+
+    void close();
+    bool closed() const;
+
+    size_t bytes() const;
+
+private:
+    struct Entry {
+        message::Message msg;
+        uint64_t seq;
+    };
+
+    // The first control message that may leave the queue before the oldest field
+    std::deque<Entry>::iterator nextControl();
+
+    const size_t maxMessages_;
+    const size_t maxBytes_;
+
+    std::deque<Entry> fields_;
+    std::deque<Entry> controls_;
+
+    // Sequence numbers of the queued fields of each source, in arrival order
+    std::map<message::Peer, std::deque<uint64_t>> sourceFields_;
+    uint64_t seq_ = 0;
+
+    size_t bytes_ = 0;
+    bool closed_ = false;
+
+    util::MemoryAccount& account_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+};
+
+}  // namespace server
+}  // namespace multio
+
+#endif
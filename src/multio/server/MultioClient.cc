@@ -2,19 +2,28 @@
 #include "MultioClient.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <exception>
 #include <fstream>
 #include <iomanip>
+#include <map>
+#include <mutex>
+#include <thread>
 
 #include "eckit/config/LocalConfiguration.h"
 #include "eckit/config/Resource.h"
 #include "eckit/config/YAMLConfiguration.h"
+#include "eckit/container/Queue.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/log/Statistics.h"
 #include "eckit/types/DateTime.h"
 
 #include "multio/LibMultio.h"
+#include "multio/action/Router.h"
 #include "multio/message/Message.h"
+#include "multio/transport/MpiCommSetup.h"
 #include "multio/transport/TransportRegistry.h"
+#include "multio/util/Tracing.h"
 #include "multio/util/logfile_name.h"
 
 using multio::message::Message;
@@ -23,7 +32,113 @@ using multio::message::Peer;
 namespace multio {
 namespace server {
 
-MultioClient::MultioClient(const ClientConfigurationContext& confCtx) : FailureAware(confCtx) {
+namespace {
+// Stamps a message entering the client with a new trace id, if tracing is enabled
+void traceMessage(Message& msg) {
+    if (util::Tracer::enabled() && msg.header().traceId() == 0) {
+        msg.setTrace(util::Tracer::newTraceId(), util::Tracer::now());
+    }
+}
+}  // namespace
+
+class MultioClient::PendingPayloads {
+public:
+    void acquire() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        ++count_;
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        ASSERT(count_ > 0);
+        if (--count_ == 0) {
+            released_.notify_all();
+        }
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock{mutex_};
+        released_.wait(lock, [this]() { return count_ == 0; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable released_;
+    size_t count_ = 0;
+};
+
+// Runs the plans on a background thread, so that the model only pays for enqueuing a message
+class MultioClient::AsyncDispatch {
+public:
+    AsyncDispatch(MultioClient& client, size_t queueSize) :
+        client_{client}, queue_{queueSize}, thread_{[this]() { run(); }} {}
+
+    ~AsyncDispatch() {
+        queue_.close();
+        thread_.join();
+    }
+
+    void push(Message msg) {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            ++pending_;
+        }
+        queue_.emplace(std::move(msg));
+    }
+
+    void barrier() {
+        std::unique_lock<std::mutex> lock{mutex_};
+        done_.wait(lock, [this]() { return pending_ == 0; });
+        if (error_) {
+            auto error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    void run() {
+        Message msg;
+        while (queue_.pop(msg) >= 0) {
+            // Messages behind a failed one are dropped until the failure has been reported at a barrier
+            if (not failed()) {
+                try {
+                    client_.runPlans(msg);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock{mutex_};
+                    error_ = std::current_exception();
+                }
+            }
+
+            // Release the payload before signalling, borrowed payloads are waited for on that basis
+            msg = Message{};
+
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (--pending_ == 0) {
+                done_.notify_all();
+            }
+        }
+    }
+
+    bool failed() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        return static_cast<bool>(error_);
+    }
+
+    MultioClient& client_;
+    eckit::Queue<Message> queue_;
+
+    std::mutex mutex_;
+    std::condition_variable done_;
+    size_t pending_ = 0;
+    std::exception_ptr error_;
+
+    std::thread thread_;
+};
+
+MultioClient::MultioClient(const ClientConfigurationContext& confCtx) :
+    FailureAware(confCtx), pendingPayloads_{std::make_shared<PendingPayloads>()} {
     ASSERT(confCtx.componentTag() == util::ComponentTag::Client);
     totClientTimer_.start();
 
@@ -46,10 +161,27 @@ MultioClient::MultioClient(const ClientConfigurationContext& confCtx) : FailureA
         plans_.back()->computeActiveFields(activeFieldInserter);
         plans_.back()->computeActiveCategories(activeCategoryInserter);
     }
+    router_.reset(new action::Router{plans_});
+
     if (confCtx.globalConfig().has("active-fields")) {
         const auto& vec = confCtx.globalConfig().getStringVector("active-fields");
         std::copy(vec.begin(), vec.end(), activeFieldInserter);
     }
+
+    if (confCtx.config().getBool("async-dispatch",
+                                 eckit::Resource<bool>("multioAsyncDispatch;$MULTIO_ASYNC_DISPATCH", false))) {
+        auto queueSize = confCtx.config().getUnsigned(
+            "async-dispatch-queue-size",
+            eckit::Resource<size_t>("multioAsyncDispatchQueueSize;$MULTIO_ASYNC_DISPATCH_QUEUE_SIZE", 1024));
+        // The background thread sends through the transports while the model may be calling MPI itself
+        if (transport::mpi::allowsConcurrentCalls()) {
+            asyncDispatch_.reset(new AsyncDispatch{*this, queueSize});
+        }
+        else {
+            eckit::Log::warning() << "MultioClient: MPI was not initialised with MPI_THREAD_MULTIPLE, "
+                                  << "falling back to synchronous dispatch" << std::endl;
+        }
+    }
 }
 
 util::FailureHandlerResponse MultioClient::handleFailure(util::OnClientError t, const util::FailureContext& c, util::DefaultFailureState&) const {
@@ -69,6 +201,7 @@ void MultioClient::openConnections() {
 }
 
 void MultioClient::closeConnections() {
+    flush();
     withFailureHandling([&]() { transport::TransportRegistry::instance().closeConnections(); },
                         []() { return std::string("MultioClient::closeConnections"); });
 }
@@ -94,13 +227,116 @@ void MultioClient::dispatch(message::Metadata metadata, eckit::Buffer&& payload,
 }
 
 void MultioClient::dispatch(message::Message msg) {
+    traceMessage(msg);
+    if (asyncDispatch_) {
+        asyncDispatch_->push(std::move(msg));
+        return;
+    }
+    runPlans(msg);
+}
+
+void MultioClient::runPlans(const message::Message& msg) {
+    util::TraceSpan span{"client-plan", msg.header().traceId()};
+    if (util::Tracer::enabled()) {
+        util::Tracer::instance().flowStart(msg.header().traceId(), util::Tracer::now());
+    }
     withFailureHandling([&]() {
-        for (const auto& plan : plans_) {
+        for (const auto& plan : router_->route(msg)) {
             plan->process(msg);
         }
     });
 }
 
+void MultioClient::flush() {
+    if (asyncDispatch_) {
+        asyncDispatch_->barrier();
+    }
+}
+
+void MultioClient::dispatch(std::vector<message::Message> msgs) {
+    for (auto& msg : msgs) {
+        traceMessage(msg);
+    }
+    if (asyncDispatch_) {
+        for (auto& msg : msgs) {
+            asyncDispatch_->push(std::move(msg));
+        }
+        return;
+    }
+    withFailureHandling([&]() { runPlans(msgs); });
+}
+
+void MultioClient::runPlans(const std::vector<message::Message>& msgs) {
+    util::TraceSpan span{"client-plan"};
+
+    // Keep the plan-by-plan order of an unrouted batch
+    std::map<action::Plan*, std::vector<message::Message>> routed;
+    for (const auto& msg : msgs) {
+        if (util::Tracer::enabled()) {
+            util::Tracer::instance().flowStart(msg.header().traceId(), util::Tracer::now());
+        }
+        for (const auto& plan : router_->route(msg)) {
+            routed[plan].push_back(msg);
+        }
+    }
+    for (const auto& plan : plans_) {
+        auto it = routed.find(plan.get());
+        if (it != routed.end()) {
+            plan->process(it->second);
+        }
+    }
+}
+
+void MultioClient::dispatchBorrowed(message::Metadata metadata, const void* data, size_t size, Message::Tag tag) {
+    ASSERT(tag < Message::Tag::ENDTAG);
+
+    auto pending = pendingPayloads_;
+    pending->acquire();
+    std::shared_ptr<Message::BorrowedPayload> borrowed{
+        new Message::BorrowedPayload{data, size, [pending]() { pending->release(); }}};
+
+    dispatch(Message{Message::Header{tag, Peer{}, Peer{}, std::move(metadata)}, std::move(borrowed)});
+}
+
+void MultioClient::dispatchBorrowed(const std::vector<BorrowedField>& fields, Message::Tag tag) {
+    ASSERT(tag < Message::Tag::ENDTAG);
+
+    // Only this batch is waited for, not data still borrowed through single-field calls
+    auto pending = std::make_shared<PendingPayloads>();
+    withFailureHandling(
+        [&]() {
+            std::vector<Message> msgs;
+            msgs.reserve(fields.size());
+            for (const auto& field : fields) {
+                pending->acquire();
+                std::shared_ptr<Message::BorrowedPayload> borrowed{
+                    new Message::BorrowedPayload{field.data, field.size, [pending]() { pending->release(); }}};
+                msgs.emplace_back(Message::Header{tag, Peer{}, Peer{}, message::Metadata{*field.metadata}},
+                                  std::move(borrowed));
+                traceMessage(msgs.back());
+            }
+
+            if (asyncDispatch_) {
+                for (auto& msg : msgs) {
+                    asyncDispatch_->push(std::move(msg));
+                }
+            }
+            else {
+                runPlans(msgs);
+            }
+            msgs.clear();
+
+            pending->wait();
+        },
+        []() { return std::string("MultioClient::dispatchBorrowed"); });
+}
+
+void MultioClient::waitBorrowed() {
+    flush();
+    withFailureHandling([&]() { pendingPayloads_->wait(); },
+                        []() { return std::string("MultioClient::waitBorrowed"); });
+}
+
 bool MultioClient::isFieldActive(const std::string& name) const {
     return activeFields_.find(name) != end(activeFields_);
 }
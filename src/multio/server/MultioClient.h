@@ -38,6 +38,10 @@ class Message;
 class Metadata;
 }
 
+namespace action {
+class Router;
+}
+
 namespace server {
 
 class Transport;
@@ -51,23 +55,59 @@ public:
     void openConnections();
     void closeConnections();
 
+    // Blocks until all messages queued for asynchronous dispatch have run through the plans
+    void flush();
+
     void dispatch(message::Metadata metadata, eckit::Buffer&& payload, message::Message::Tag tag);
 
     void dispatch(message::Message msg);
-    
+
+    // Runs a batch of messages, e.g. all levels of a 3D field, through every plan in one go
+    void dispatch(std::vector<message::Message> msgs);
+
+    // Dispatches caller-owned memory without copying it. The memory must not be modified before waitBorrowed()
+    // has returned.
+    void dispatchBorrowed(message::Metadata metadata, const void* data, size_t size, message::Message::Tag tag);
+
+    // Caller-owned field of a batch, referenced rather than copied
+    struct BorrowedField {
+        const message::Metadata* metadata;
+        const void* data;
+        size_t size;
+    };
+
+    // Runs a batch of caller-owned fields through every plan in one go, and blocks until no message refers to
+    // their memory any more
+    void dispatchBorrowed(const std::vector<BorrowedField>& fields, message::Message::Tag tag);
+
+    // Blocks until no message refers to caller-owned memory passed through dispatchBorrowed()
+    void waitBorrowed();
+
     bool isFieldActive(const std::string& name) const;
     bool isCategoryActive(const std::string& name) const;
     
     util::FailureHandlerResponse handleFailure(util::OnClientError, const util::FailureContext&, util::DefaultFailureState&) const override;
 
 private:
+    class PendingPayloads;
+    class AsyncDispatch;
+
+    void runPlans(const message::Message& msg);
+    void runPlans(const std::vector<message::Message>& msgs);
+
     std::vector<std::unique_ptr<action::Plan>> plans_;
+    std::unique_ptr<action::Router> router_;
     std::set<std::string> activeFields_;
     std::set<std::string> activeCategories_;
 
+    // Shared with the release callbacks of borrowed payloads, which may outlive the client
+    std::shared_ptr<PendingPayloads> pendingPayloads_;
 
     eckit::Timing totClientTiming_;
     eckit::Timer totClientTimer_;
+
+    // Declared last, so that the dispatch thread is joined before anything it uses is destroyed
+    std::unique_ptr<AsyncDispatch> asyncDispatch_;
 };
 
 }  // namespace server
@@ -0,0 +1,154 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "BufferCodec.h"
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/compression/Compressor.h"
+
+namespace multio {
+namespace transport {
+
+namespace {
+
+// Frame: original size, shuffle width, length of the compressor name, the name and the compressed bytes
+struct FrameHeader {
+    uint64_t size;
+    uint32_t shuffle;
+    uint32_t nameLength;
+};
+
+void reserve(eckit::Buffer& buf, size_t size) {
+    if (buf.size() < size) {
+        buf.resize(size);
+    }
+}
+
+// Byte b of element i goes to plane b. Reads are sequential and each plane is written sequentially.
+void shuffle(const unsigned char* in, size_t size, size_t width, unsigned char* out) {
+    const size_t count = size / width;
+    for (size_t i = 0; i != count; ++i) {
+        for (size_t b = 0; b != width; ++b) {
+            out[b * count + i] = in[i * width + b];
+        }
+    }
+    std::memcpy(out + count * width, in + count * width, size - count * width);
+}
+
+void unshuffle(const unsigned char* in, size_t size, size_t width, unsigned char* out) {
+    const size_t count = size / width;
+    for (size_t i = 0; i != count; ++i) {
+        for (size_t b = 0; b != width; ++b) {
+            out[i * width + b] = in[b * count + i];
+        }
+    }
+    std::memcpy(out + count * width, in + count * width, size - count * width);
+}
+
+}  // namespace
+
+BufferCodec::BufferCodec() : BufferCodec{"none", 0, 1.0} {}
+
+BufferCodec::BufferCodec(const std::string& compression, size_t shuffle, double minRatio) :
+    compression_{compression}, shuffle_{shuffle > 1 ? shuffle : 0}, minRatio_{minRatio} {
+    if (enabled()) {
+        compressor(compression_);
+    }
+}
+
+BufferCodec::~BufferCodec() = default;
+
+BufferCodec::BufferCodec(BufferCodec&&) = default;
+
+bool BufferCodec::enabled() const {
+    return compression_ != "none";
+}
+
+size_t BufferCodec::encode(const void* data, size_t size, eckit::Buffer& out) {
+    if (not enabled() || size == 0) {
+        return 0;
+    }
+
+    const auto& comp = compressor(compression_);
+
+    const void* input = data;
+    if (shuffle_ != 0) {
+        reserve(shuffled_, size);
+        shuffle(static_cast<const unsigned char*>(data), size, shuffle_, static_cast<unsigned char*>(shuffled_.data()));
+        input = shuffled_.data();
+    }
+
+    const auto compressedSize = comp.compress(input, size, compressed_);
+
+    const FrameHeader header{size, static_cast<uint32_t>(shuffle_), static_cast<uint32_t>(compression_.size())};
+    const auto frameSize = sizeof(header) + compression_.size() + compressedSize;
+    if (frameSize * minRatio_ > size) {
+        return 0;
+    }
+
+    reserve(out, frameSize);
+    auto p = static_cast<char*>(out.data());
+    std::memcpy(p, &header, sizeof(header));
+    std::memcpy(p + sizeof(header), compression_.data(), compression_.size());
+    std::memcpy(p + sizeof(header) + compression_.size(), compressed_.data(), compressedSize);
+
+    return frameSize;
+}
+
+size_t BufferCodec::decode(const void* frame, size_t size, eckit::Buffer& out) {
+    FrameHeader header;
+    ASSERT(size >= sizeof(header));
+    std::memcpy(&header, frame, sizeof(header));
+
+    const auto p = static_cast<const char*>(frame);
+    const auto payload = sizeof(header) + header.nameLength;
+    ASSERT(size >= payload);
+
+    const auto& comp = compressor(std::string{p + sizeof(header), header.nameLength});
+    const auto original = static_cast<size_t>(header.size);
+
+    if (header.shuffle == 0) {
+        reserve(out, original);
+        comp.uncompress(p + payload, size - payload, out, original);
+    }
+    else {
+        reserve(shuffled_, original);
+        comp.uncompress(p + payload, size - payload, shuffled_, original);
+        reserve(out, original);
+        unshuffle(static_cast<const unsigned char*>(shuffled_.data()), original, header.shuffle,
+                  static_cast<unsigned char*>(out.data()));
+    }
+
+    return original;
+}
+
+const eckit::Compressor& BufferCodec::compressor(const std::string& name) {
+    auto it = compressors_.find(name);
+    if (it != std::end(compressors_)) {
+        return *it->second;
+    }
+
+    auto& factory = eckit::CompressorFactory::instance();
+    if (not factory.has(name)) {
+        std::ostringstream oss;
+        oss << "Compression " << name << " is not available for the transport, eckit provides ";
+        factory.list(oss);
+        throw eckit::UserError(oss.str(), Here());
+    }
+
+    return *compressors_.emplace(name, std::unique_ptr<eckit::Compressor>{factory.build(name)}).first->second;
+}
+
+}  // namespace transport
+}  // namespace multio
@@ -0,0 +1,75 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Nov 2022
+
+/// Lossless compression of whole transport buffers. The bytes are first shuffled by element width, so that
+/// the bytes of the same significance of all floating-point values lie next to each other, and then
+/// compressed with one of the compressors of eckit (e.g. lz4). Each compressed buffer is a self-describing
+/// frame that names its compressor, hence a receiver decodes whatever its senders chose to use.
+
+#ifndef multio_transport_BufferCodec_H
+#define multio_transport_BufferCodec_H
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "eckit/io/Buffer.h"
+
+namespace eckit {
+class Compressor;
+}
+
+namespace multio {
+namespace transport {
+
+class BufferCodec {
+public:
+    // Only decodes
+    BufferCodec();
+
+    // A compression of "none" disables encoding. A shuffle width of 0 or 1 disables the byte shuffle.
+    // Buffers that do not compress by at least minRatio are left as they are.
+    BufferCodec(const std::string& compression, size_t shuffle, double minRatio);
+
+    ~BufferCodec();
+
+    BufferCodec(BufferCodec&&);
+
+    bool enabled() const;
+
+    // Writes the frame for size bytes at data to out and returns its size, or 0 if not worth it
+    size_t encode(const void* data, size_t size, eckit::Buffer& out);
+
+    // Writes the original bytes of a frame to out and returns their number
+    size_t decode(const void* frame, size_t size, eckit::Buffer& out);
+
+private:
+    const eckit::Compressor& compressor(const std::string& name);
+
+    std::string compression_;
+    size_t shuffle_;
+    double minRatio_;
+
+    std::map<std::string, std::unique_ptr<eckit::Compressor>> compressors_;
+
+    eckit::Buffer shuffled_;
+    eckit::Buffer compressed_;
+};
+
+// Data in MPI buffers sent with this bit set in the tag is compressed
+constexpr int compressedTagBit = 1 << 10;
+
+}  // namespace transport
+}  // namespace multio
+
+#endif  // multio_transport_BufferCodec_H
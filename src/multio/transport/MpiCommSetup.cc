@@ -5,6 +5,12 @@
 #include "eckit/thread/AutoLock.h"
 #include "eckit/thread/Mutex.h"
 
+#include "multio/multio_config.h"
+
+#ifdef MULTIO_HAVE_MPI
+#include <mpi.h>
+#endif
+
 
 namespace multio {
 namespace transport {
@@ -191,6 +197,24 @@ eckit::mpi::Comm& getComm(const ConfigurationContext& confCtx, const std::string
         options);
 };
 
+bool allowsConcurrentCalls() {
+#ifdef MULTIO_HAVE_MPI
+    int initialized = 0;
+    int finalized = 0;
+    MPI_Initialized(&initialized);
+    MPI_Finalized(&finalized);
+    if (not initialized || finalized) {
+        return true;
+    }
+
+    int provided = MPI_THREAD_SINGLE;
+    MPI_Query_thread(&provided);
+    return provided == MPI_THREAD_MULTIPLE;
+#else
+    return true;
+#endif
+}
+
 }  // namespace mpi
 }  // namespace transport
 }  // namespace multio
@@ -52,6 +52,9 @@ eckit::mpi::Comm& getComm(
 
 inline CommSetupType parseType(const std::string& typeString);
 
+// Whether MPI may be called from several threads at once -- trivially true while MPI is not in use
+bool allowsConcurrentCalls();
+
 }  // namespace mpi
 }  // namespace transport
 }  // namespace multio
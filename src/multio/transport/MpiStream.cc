@@ -50,8 +50,8 @@ std::string MpiOutputStream::name() const {
     return "MpiOutputStream(" + st2str.at(buf_.status) + ")";
 }
 
-MpiInputStream::MpiInputStream(MpiBuffer& buf, size_t sz) :
-    eckit::ResizableMemoryStream{buf.content}, buf_{buf}, size_{sz} {}
+MpiInputStream::MpiInputStream(MpiBuffer& buf, size_t sz, bool compressed) :
+    eckit::ResizableMemoryStream{buf.content}, buf_{buf}, size_{sz}, compressed_{compressed} {}
 
 MpiBuffer& MpiInputStream::buffer() const {
     return buf_;
@@ -61,6 +61,10 @@ size_t MpiInputStream::size() const {
     return size_;
 }
 
+bool MpiInputStream::compressed() const {
+    return compressed_;
+}
+
 std::string MpiInputStream::name() const {
     static const std::map<BufferStatus, std::string> st2str{
         {BufferStatus::available, "available"},
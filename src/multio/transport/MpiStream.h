@@ -30,6 +30,9 @@ public:
     BufferStatus status = BufferStatus::available;
     eckit::mpi::Request request;
     eckit::Buffer content;
+
+    // Compressed content while it is being transmitted
+    eckit::Buffer packed;
 };
 
 class MpiOutputStream : public eckit::ResizableMemoryStream {
@@ -49,17 +52,21 @@ private:
 
 class MpiInputStream : public eckit::ResizableMemoryStream {
 public:
-    MpiInputStream(MpiBuffer& buf, size_t sz);
+    MpiInputStream(MpiBuffer& buf, size_t sz, bool compressed = false);
 
     MpiBuffer& buffer() const;
 
     size_t size() const;
 
+    // The content is a frame of the BufferCodec
+    bool compressed() const;
+
 private:
     std::string name() const override;
 
     MpiBuffer& buf_;
     size_t size_;
+    bool compressed_;
 };
 
 }  // namespace transport
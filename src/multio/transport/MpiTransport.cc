@@ -22,6 +22,7 @@
 
 #include "multio/transport/MpiCommSetup.h"
 #include "multio/util/ScopedTimer.h"
+#include "multio/util/Tracing.h"
 #include "multio/util/logfile_name.h"
 
 namespace multio {
@@ -45,20 +46,33 @@ Message decodeMessage(eckit::Stream& stream) {
     std::string fieldId;
     stream >> fieldId;
 
+    unsigned long long traceId;
+    stream >> traceId;
+    long long traceTimestamp;
+    stream >> traceTimestamp;
+
     unsigned long sz;
     stream >> sz;
 
     eckit::Buffer buffer(sz);
     stream >> buffer;
 
-    return Message{Message::Header{static_cast<Message::Tag>(t), MpiPeer{src_grp, src_id}, MpiPeer{dest_grp, dest_id},
-                                   std::move(fieldId)},
-                   std::move(buffer)};
+    Message::Header header{static_cast<Message::Tag>(t), MpiPeer{src_grp, src_id}, MpiPeer{dest_grp, dest_id},
+                           std::move(fieldId)};
+    header.setTrace(traceId, traceTimestamp);
+
+    return Message{std::move(header), std::move(buffer)};
 }
 
 const size_t defaultBufferSize = 64 * 1024 * 1024;
 const size_t defaultPoolSize = 128;
 
+BufferCodec makeCodec() {
+    return BufferCodec{eckit::Resource<std::string>("multioMpiCompression;$MULTIO_MPI_COMPRESSION", "none"),
+                       eckit::Resource<size_t>("multioMpiShuffle;$MULTIO_MPI_SHUFFLE", sizeof(double)),
+                       eckit::Resource<double>("multioMpiCompressionMinRatio;$MULTIO_MPI_COMPRESSION_MIN_RATIO", 1.1)};
+}
+
 MpiPeerSetup setupMPI_(const ConfigurationContext& confCtx) {
     // if (!confCtx.config().has("group")) {
     //     std::ostringstream oss;
@@ -157,8 +171,8 @@ MpiTransport::MpiTransport(const ConfigurationContext& confCtx, MpiPeerSetup&& p
     clientGroup_{std::move(std::get<2>(peerSetup))},
     serverGroup_{std::move(std::get<3>(peerSetup))},
     pool_{eckit::Resource<size_t>("multioMpiPoolSize;$MULTIO_MPI_POOL_SIZE", defaultPoolSize),
-          eckit::Resource<size_t>("multioMpiBufferSize;$MULTIO_MPI_BUFFER_SIZE", defaultBufferSize), comm(),
-          statistics_} {}
+          eckit::Resource<size_t>("multioMpiBufferSize;$MULTIO_MPI_BUFFER_SIZE", defaultBufferSize),
+          eckit::Resource<size_t>("multioMpiCredit;$MULTIO_MPI_CREDIT", 0), makeCodec(), comm(), statistics_} {}
 
 MpiTransport::MpiTransport(const ConfigurationContext& confCtx) : MpiTransport(confCtx, setupMPI_(confCtx)) {}
 
@@ -184,6 +198,17 @@ void MpiTransport::closeConnections() {
     pool_.waitAll();
 }
 
+template <typename MemoryStream>
+void MpiTransport::decodeMessages(MemoryStream& strm, size_t size) {
+    while (strm.position() < size) {
+        util::ScopedTiming decodeTiming{statistics_.decodeTimer_, statistics_.decodeTiming_, statistics_.decodeLatency_};
+        util::TraceSpan span{"decode"};
+        auto msg = decodeMessage(strm);
+        span.traceId(msg.header().traceId());
+        msgPack_.push(msg);
+    }
+}
+
 Message MpiTransport::receive() {
     util::ScopedTiming timing{statistics_.totReturnTimer_, statistics_.totReturnTiming_};
     /**
@@ -196,7 +221,7 @@ Message MpiTransport::receive() {
 
     do {
         while (not msgPack_.empty()) {
-            util::ScopedTiming retTiming{statistics_.returnTimer_, statistics_.returnTiming_};
+            util::ScopedTiming retTiming{statistics_.returnTimer_, statistics_.returnTiming_, statistics_.returnLatency_};
             //! TODO For switch to MPMC queue: combine front() and pop()
             auto msg = msgPack_.front();
             msgPack_.pop();
@@ -205,10 +230,19 @@ Message MpiTransport::receive() {
 
         //! TODO For switch to MPMC queue: combine front() and pop()
         if (auto strm = streamQueue_.front()) {
-            while (strm->position() < strm->size()) {
-                util::ScopedTiming decodeTiming{statistics_.decodeTimer_, statistics_.decodeTiming_};
-                auto msg = decodeMessage(*strm);
-                msgPack_.push(msg);
+            if (strm->compressed()) {
+                size_t sz = 0;
+                {
+                    util::ScopedTiming decompressTiming{statistics_.decompressTimer_, statistics_.decompressTiming_,
+                                                        statistics_.decompressLatency_};
+                    util::TraceSpan span{"decompress"};
+                    sz = codec_.decode(strm->buffer().content.data(), strm->size(), inflated_);
+                }
+                eckit::MemoryStream inflated{inflated_.data(), sz};
+                decodeMessages(inflated, sz);
+            }
+            else {
+                decodeMessages(*strm, strm->size());
             }
             streamQueue_.pop();
         }
@@ -223,6 +257,11 @@ void MpiTransport::abort() {
 void MpiTransport::send(const Message& msg) {
     std::lock_guard<std::mutex> lock{mutex_};
 
+    pool_.acquireCredit(msg.destination(), msg.size());
+
+    // Keeps the order with the fields buffered for the same server
+    pool_.flushStream(msg.destination(), static_cast<int>(Message::Tag::Field));
+
     auto msg_tag = static_cast<int>(msg.tag());
 
     // TODO: find available buffer instead
@@ -233,7 +272,8 @@ void MpiTransport::send(const Message& msg) {
 
     encodeMessage(stream, msg);
 
-    util::ScopedTiming timing{statistics_.sendTimer_, statistics_.sendTiming_};
+    util::ScopedTiming timing{statistics_.sendTimer_, statistics_.sendTiming_, statistics_.sendLatency_};
+    util::TraceSpan span{"send"};
 
     auto sz = static_cast<size_t>(stream.bytesWritten());
     auto dest = static_cast<int>(msg.destination().id());
@@ -244,11 +284,27 @@ void MpiTransport::send(const Message& msg) {
 
     ++statistics_.sendCount_;
     statistics_.sendSize_ += sz;
+    statistics_.sentBytes_->add(sz);
 }
 
 void MpiTransport::bufferedSend(const Message& msg) {
     std::lock_guard<std::mutex> lock{mutex_};
+    pool_.acquireCredit(msg.destination(), msg.size());
     encodeMessage(pool_.getStream(msg), msg);
+
+    // Control messages do not wait for the buffer to fill up. Behind the fields already in it, they
+    // leave under their own tag.
+    if (Message::isControl(msg.tag())) {
+        pool_.flushStream(msg.destination(), static_cast<int>(msg.tag()));
+    }
+}
+
+void MpiTransport::grantCredit(const Peer& client, size_t bytes) {
+    pool_.grantCredit(client, bytes);
+}
+
+void MpiTransport::revokeCredit(const Peer& client) {
+    pool_.revokeCredit(client);
 }
 
 void MpiTransport::createPeers() const {
@@ -283,6 +339,9 @@ Peer MpiTransport::localPeer() const {
 }
 
 void MpiTransport::listen() {
+    // Only the listening thread communicates, hence it also passes on the credit granted by the listener
+    pool_.sendCredits();
+
     auto status = probe();
     if (status.error()) {
         return;
@@ -291,8 +350,9 @@ void MpiTransport::listen() {
     // large buffer?
     auto& buf = pool_.findAvailableBuffer();
     auto sz = blockingReceive(status, buf);
-    util::ScopedTiming timing{statistics_.pushToQueueTimer_, statistics_.pushToQueueTiming_};
-    streamQueue_.emplace(buf, sz);
+    util::ScopedTiming timing{statistics_.pushToQueueTimer_, statistics_.pushToQueueTiming_, statistics_.pushToQueueLatency_};
+    util::TraceSpan span{"push-queue"};
+    streamQueue_.emplace(buf, sz, (status.tag() & compressedTagBit) != 0);
 }
 
 PeerList MpiTransport::createServerPeers() const {
@@ -320,9 +380,15 @@ const eckit::mpi::Comm& MpiTransport::comm() const {
 }
 
 eckit::mpi::Status MpiTransport::probe() {
-    util::ScopedTiming timing{statistics_.probeTimer_, statistics_.probeTiming_};
+    util::ScopedTiming timing{statistics_.probeTimer_, statistics_.probeTiming_, statistics_.probeLatency_};
+    util::TraceSpan span{"probe"};
     auto status = comm().iProbe(comm().anySource(), comm().anyTag());
 
+    // Polling would otherwise flood the trace
+    if (status.error()) {
+        span.discard();
+    }
+
     return status;
 }
 
@@ -330,17 +396,20 @@ size_t MpiTransport::blockingReceive(eckit::mpi::Status& status, MpiBuffer& buff
     auto sz = comm().getCount<void>(status);
     ASSERT(sz < buffer.content.size());
 
-    util::ScopedTiming timing{statistics_.receiveTimer_, statistics_.receiveTiming_};
+    util::ScopedTiming timing{statistics_.receiveTimer_, statistics_.receiveTiming_, statistics_.receiveLatency_};
+    util::TraceSpan span{"receive"};
     comm().receive<void>(buffer.content, sz, status.source(), status.tag());
 
     ++statistics_.receiveCount_;
     statistics_.receiveSize_ += sz;
+    statistics_.receivedBytes_->add(sz);
 
     return sz;
 }
 
 void MpiTransport::encodeMessage(eckit::Stream& strm, const Message& msg) {
-    util::ScopedTiming timing{statistics_.encodeTimer_, statistics_.encodeTiming_};
+    util::ScopedTiming timing{statistics_.encodeTimer_, statistics_.encodeTiming_, statistics_.encodeLatency_};
+    util::TraceSpan span{"encode", msg.header().traceId()};
 
     msg.encode(strm);
 }
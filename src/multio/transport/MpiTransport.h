@@ -26,6 +26,7 @@
 #include "eckit/mpi/Group.h"
 #include "eckit/serialisation/ResizableMemoryStream.h"
 
+#include "multio/transport/BufferCodec.h"
 #include "multio/transport/StreamPool.h"
 #include "multio/transport/StreamQueue.h"
 #include "multio/transport/Transport.h"
@@ -62,6 +63,9 @@ private:
 
     void listen() override;
 
+    void grantCredit(const Peer& client, size_t bytes) override;
+    void revokeCredit(const Peer& client) override;
+
     PeerList createServerPeers() const override;
 
     const eckit::mpi::Comm& comm() const;
@@ -71,6 +75,10 @@ private:
 
     void encodeMessage(eckit::Stream& strm, const Message& msg);
 
+    // Decodes the messages in the first size bytes of the stream into msgPack_
+    template <typename MemoryStream>
+    void decodeMessages(MemoryStream& strm, size_t size);
+
     MpiPeer local_;
     eckit::mpi::Group parentGroup_;
     eckit::mpi::Group clientGroup_;
@@ -80,6 +88,10 @@ private:
 
     StreamQueue streamQueue_;
     std::queue<Message> msgPack_;
+
+    // Decompresses received buffers
+    BufferCodec codec_;
+    eckit::Buffer inflated_;
 };
 
 }  // namespace transport
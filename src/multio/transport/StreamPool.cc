@@ -8,7 +8,9 @@
 #include "eckit/mpi/Comm.h"
 #include "eckit/types/DateTime.h"
 
+#include "multio/util/MemoryAccount.h"
 #include "multio/util/ScopedTimer.h"
+#include "multio/util/Tracing.h"
 
 namespace multio {
 namespace transport {
@@ -18,6 +20,7 @@ std::vector<MpiBuffer> makeBuffers(size_t poolSize, size_t maxBufSize) {
     std::vector<MpiBuffer> bufs;
     LOG_DEBUG_LIB(multio::LibMultio) << "*** Allocating " << poolSize << " buffers of size "
                                      << maxBufSize / 1024 / 1024 << " each" << std::endl;
+    util::MemoryAccount::get("transport-buffers").add(poolSize * maxBufSize, poolSize);
     double totMem = 0.0;
     for (auto ii = 0u; ii < poolSize; ++ii) {
         bufs.emplace_back(maxBufSize);
@@ -33,9 +36,13 @@ std::vector<MpiBuffer> makeBuffers(size_t poolSize, size_t maxBufSize) {
 MpiPeer::MpiPeer(const std::string& comm, size_t rank) : Peer{comm, rank} {}
 MpiPeer::MpiPeer(Peer peer) : Peer{peer} {}
 
-StreamPool::StreamPool(size_t poolSize, size_t maxBufSize, const eckit::mpi::Comm& comm,
-                       TransportStatistics& stats) :
-    comm_{comm}, statistics_{stats}, buffers_(makeBuffers(poolSize, maxBufSize)) {}
+StreamPool::StreamPool(size_t poolSize, size_t maxBufSize, size_t credit, BufferCodec&& codec,
+                       const eckit::mpi::Comm& comm, TransportStatistics& stats) :
+    comm_{comm},
+    statistics_{stats},
+    buffers_(makeBuffers(poolSize, maxBufSize)),
+    codec_{std::move(codec)},
+    credit_{static_cast<long>(credit)} {}
 
 MpiBuffer& StreamPool::buffer(size_t idx) {
     return buffers_[idx];
@@ -86,10 +93,18 @@ void StreamPool::sendBuffer(const message::Peer& dest, int msg_tag) {
         << ", timestamps: " << eckit::DateTime{static_cast<double>(tstamp.tv_sec)}.time().now()
         << ":" << std::setw(6) << std::setfill('0') << mSecs;
 
-    util::ScopedTiming(statistics_.isendTimer_, statistics_.isendTiming_);
+    auto& buf = strm.buffer();
+    if (auto packedSize = compress(buf, sz)) {
+        sz = packedSize;
+        msg_tag |= compressedTagBit;
+    }
+
+    util::ScopedTiming timing{statistics_.isendTimer_, statistics_.isendTiming_, statistics_.isendLatency_};
+    util::TraceSpan span{"isend"};
 
-    strm.buffer().request = comm_.iSend<void>(strm.buffer().content, sz, destId, msg_tag);
-    strm.buffer().status = BufferStatus::transmitting;
+    const void* data = (msg_tag & compressedTagBit) ? buf.packed.data() : buf.content.data();
+    buf.request = comm_.iSend<void>(data, sz, destId, msg_tag);
+    buf.status = BufferStatus::transmitting;
 
     ::gettimeofday(&tstamp, 0);
     mSecs = tstamp.tv_usec;
@@ -98,10 +113,39 @@ void StreamPool::sendBuffer(const message::Peer& dest, int msg_tag) {
 
     ++statistics_.isendCount_;
     statistics_.isendSize_ += sz;
+    statistics_.sentBytes_->add(sz);
+}
+
+void StreamPool::flushStream(const message::Peer& dest, int msg_tag) {
+    auto strm = streams_.find(MpiPeer{dest});
+    if (strm != std::end(streams_) && strm->second.bytesWritten() > 0) {
+        sendBuffer(dest, msg_tag);
+        streams_.erase(strm);
+    }
+}
+
+size_t StreamPool::compress(MpiBuffer& buf, size_t sz) {
+    if (not codec_.enabled()) {
+        return 0;
+    }
+
+    util::ScopedTiming timing{statistics_.compressTimer_, statistics_.compressTiming_, statistics_.compressLatency_};
+    util::TraceSpan span{"compress"};
+
+    const auto capacity = buf.packed.size();
+    const auto packedSize = codec_.encode(buf.content.data(), sz, buf.packed);
+    if (buf.packed.size() > capacity) {
+        util::MemoryAccount::get("transport-buffers").add(buf.packed.size() - capacity, 0);
+    }
+
+    statistics_.recordCompression(sz, packedSize);
+
+    return packedSize;
 }
 
 MpiBuffer& StreamPool::findAvailableBuffer(std::ostream& os) {
-    util::ScopedTiming(statistics_.waitTimer_, statistics_.waitTiming_);
+    util::ScopedTiming timing{statistics_.waitTimer_, statistics_.waitTiming_, statistics_.waitLatency_};
+    util::TraceSpan span{"buffer"};
 
     auto it = std::end(buffers_);
     while (it == std::end(buffers_)) {
@@ -118,11 +162,78 @@ MpiBuffer& StreamPool::findAvailableBuffer(std::ostream& os) {
 }
 
 void StreamPool::waitAll() {
-    util::ScopedTiming(statistics_.waitTimer_, statistics_.waitTiming_);
+    util::ScopedTiming timing{statistics_.waitTimer_, statistics_.waitTiming_, statistics_.waitLatency_};
     while (not std::all_of(std::begin(buffers_), std::end(buffers_),
                            [](MpiBuffer& buf) { return buf.isFree(); })) {}
 }
 
+void StreamPool::acquireCredit(const message::Peer& dest, size_t bytes) {
+    if (credit_ == 0) {
+        return;
+    }
+
+    auto& credit = credits_.emplace(MpiPeer{dest}, credit_).first->second;
+    const auto size = static_cast<long>(bytes);
+    const auto destId = static_cast<int>(dest.id());
+    const auto creditTag = static_cast<int>(message::Message::Tag::Credit);
+
+    while (not comm_.iProbe(destId, creditTag).error()) {
+        long granted = 0;
+        comm_.receive(&granted, 1, destId, creditTag);
+        credit += granted;
+    }
+
+    // A message larger than the full credit is sent once everything before it has been queued
+    if (credit < size && credit < credit_) {
+        util::ScopedTiming timing{statistics_.creditTimer_, statistics_.creditTiming_, statistics_.creditLatency_};
+        util::TraceSpan span{"credit"};
+
+        // The server can only grant credit for what it has received
+        flushStream(dest, static_cast<int>(message::Message::Tag::Field));
+
+        while (credit < size && credit < credit_) {
+            long granted = 0;
+            comm_.receive(&granted, 1, destId, creditTag);
+            credit += granted;
+        }
+    }
+
+    credit -= size;
+}
+
+void StreamPool::grantCredit(const message::Peer& client, size_t bytes) {
+    if (credit_ == 0 || bytes == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock{grantsMutex_};
+    if (revoked_.find(MpiPeer{client}) == std::end(revoked_)) {
+        grants_[MpiPeer{client}] += static_cast<long>(bytes);
+    }
+}
+
+void StreamPool::revokeCredit(const message::Peer& client) {
+    if (credit_ == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock{grantsMutex_};
+    revoked_.insert(MpiPeer{client});
+    grants_.erase(MpiPeer{client});
+}
+
+void StreamPool::sendCredits() {
+    if (credit_ == 0) {
+        return;
+    }
+
+    // Sent under the lock, so that no credit reaches a client after its connection has been closed
+    std::lock_guard<std::mutex> lock{grantsMutex_};
+    for (const auto& grant : grants_) {
+        comm_.send(&grant.second, 1, static_cast<int>(grant.first.id()),
+                   static_cast<int>(message::Message::Tag::Credit));
+    }
+    grants_.clear();
+}
+
 MpiOutputStream& StreamPool::createNewStream(const message::Peer& dest) {
     if (buffers_.size() < streams_.size()) {
         throw eckit::BadValue("Too few buffers to cover all MPI destinations", Here());
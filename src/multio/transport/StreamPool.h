@@ -2,10 +2,14 @@
 #ifndef multio_transport_StreamPool_H
 #define multio_transport_StreamPool_H
 
+#include <map>
+#include <mutex>
+#include <set>
 #include <sstream>
 
 #include "multio/LibMultio.h"
 #include "multio/message/Message.h"
+#include "multio/transport/BufferCodec.h"
 #include "multio/transport/MpiStream.h"
 #include "multio/transport/TransportStatistics.h"
 
@@ -20,8 +24,11 @@ public:
 
 class StreamPool {
 public:
-    explicit StreamPool(size_t poolSize, size_t maxBufSize, const eckit::mpi::Comm& comm,
-                        TransportStatistics& stats);
+    // A non-zero credit enables flow control: a client may only send that many payload bytes to a
+    // server ahead of what the server has queued for dispatching. Buffers are compressed by the codec, if
+    // it is enabled and they compress well enough.
+    explicit StreamPool(size_t poolSize, size_t maxBufSize, size_t credit, BufferCodec&& codec,
+                        const eckit::mpi::Comm& comm, TransportStatistics& stats);
 
     MpiBuffer& buffer(size_t idx);
 
@@ -29,14 +36,31 @@ public:
 
     void sendBuffer(const message::Peer& dest, int msg_tag);
 
+    // Sends whatever is buffered for the destination straight away and starts a new buffer for it
+    void flushStream(const message::Peer& dest, int msg_tag);
+
     MpiBuffer& findAvailableBuffer(std::ostream& os = eckit::Log::debug<LibMultio>());
 
     void waitAll();
 
+    // Client side of the flow control: waits for the server to grant enough credit for another message
+    // of the given size, sending whatever is buffered for it in the meantime. Credit that has arrived is
+    // received on every call, so that grants do not pile up unreceived.
+    void acquireCredit(const message::Peer& dest, size_t bytes);
+
+    // Server side of the flow control: grants are collected from any thread and sent by sendCredits()
+    // from the thread that receives. Once a client has closed its connection, it is granted nothing more.
+    void grantCredit(const message::Peer& client, size_t bytes);
+    void revokeCredit(const message::Peer& client);
+    void sendCredits();
+
 private:
     MpiOutputStream& createNewStream(const message::Peer& dest);
     MpiOutputStream& replaceStream(const message::Peer& dest);
 
+    // Returns the size of the compressed content in buf.packed, or 0 if it is to be sent as it is
+    size_t compress(MpiBuffer& buf, size_t sz);
+
     void print(std::ostream& os) const;
 
     friend std::ostream& operator<<(std::ostream& os, const StreamPool& pool) {
@@ -47,10 +71,18 @@ private:
     const eckit::mpi::Comm& comm_;
     TransportStatistics& statistics_;
     std::vector<MpiBuffer> buffers_;
+    BufferCodec codec_;
     std::map<MpiPeer, MpiOutputStream> streams_;
 
     std::map<MpiPeer, unsigned int> counter_;
     std::ostringstream os_;
+
+    const long credit_;
+    std::map<MpiPeer, long> credits_;
+
+    std::mutex grantsMutex_;
+    std::map<MpiPeer, long> grants_;
+    std::set<MpiPeer> revoked_;
 };
 
 }  // namespace transport
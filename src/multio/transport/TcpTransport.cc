@@ -41,15 +41,22 @@ Message decodeMessage(eckit::Stream& stream) {
     std::string fieldId;
     stream >> fieldId;
 
+    unsigned long long traceId;
+    stream >> traceId;
+    long long traceTimestamp;
+    stream >> traceTimestamp;
+
     unsigned long sz;
     stream >> sz;
 
     eckit::Buffer buffer(sz);
     stream >> buffer;
 
-    return Message{Message::Header{static_cast<Message::Tag>(t), TcpPeer{src_grp, src_id},
-                                   TcpPeer{dest_grp, dest_id}, std::move(fieldId)},
-                   std::move(buffer)};
+    Message::Header header{static_cast<Message::Tag>(t), TcpPeer{src_grp, src_id}, TcpPeer{dest_grp, dest_id},
+                           std::move(fieldId)};
+    header.setTrace(traceId, traceTimestamp);
+
+    return Message{std::move(header), std::move(buffer)};
 }
 }  // namespace
 
@@ -34,6 +34,10 @@ Transport::~Transport() = default;
 
 void Transport::listen() {}
 
+void Transport::grantCredit(const Peer&, size_t) {}
+
+void Transport::revokeCredit(const Peer&) {}
+
 const PeerList& Transport::clientPeers() const {
     if(peersMissing()) {
         createPeers();
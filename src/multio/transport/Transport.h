@@ -62,6 +62,12 @@ public:  // methods
 
     virtual void listen();
 
+    // Server side of the flow control: the given client may send another number of payload bytes
+    virtual void grantCredit(const Peer& client, size_t bytes);
+
+    // The given client has closed its connection and is granted no more credit
+    virtual void revokeCredit(const Peer& client);
+
     virtual PeerList createServerPeers() const = 0;
 
     const PeerList& clientPeers() const;
@@ -1,14 +1,57 @@
 
 #include "TransportStatistics.h"
 
+#include <algorithm>
+#include <ostream>
+
 namespace multio {
 namespace transport {
 
-TransportStatistics::TransportStatistics() {}
+namespace {
+util::Histogram* stageLatency(const std::string& stage) {
+    return &util::Metrics::instance().histogram("transport_latency", {{"stage", stage}});
+}
+}  // namespace
+
+TransportStatistics::TransportStatistics() :
+    waitLatency_{stageLatency("wait")},
+    isendLatency_{stageLatency("isend")},
+    sendLatency_{stageLatency("send")},
+    encodeLatency_{stageLatency("encode")},
+    probeLatency_{stageLatency("probe")},
+    receiveLatency_{stageLatency("receive")},
+    pushToQueueLatency_{stageLatency("push-queue")},
+    decodeLatency_{stageLatency("decode")},
+    returnLatency_{stageLatency("return")},
+    creditLatency_{stageLatency("credit")},
+    compressLatency_{stageLatency("compress")},
+    decompressLatency_{stageLatency("decompress")},
+    sentBytes_{&util::Metrics::instance().counter("transport_sent_bytes")},
+    receivedBytes_{&util::Metrics::instance().counter("transport_received_bytes")},
+    compressInBytes_{&util::Metrics::instance().counter("transport_compress_input_bytes")},
+    compressOutBytes_{&util::Metrics::instance().counter("transport_compress_output_bytes")} {}
+
+void TransportStatistics::recordCompression(std::size_t size, std::size_t compressedSize) {
+    if (compressedSize == 0) {
+        ++incompressibleCount_;
+        return;
+    }
+
+    const auto ratio = static_cast<double>(size) / static_cast<double>(compressedSize);
+    minCompressRatio_ = compressCount_ ? std::min(minCompressRatio_, ratio) : ratio;
+    maxCompressRatio_ = compressCount_ ? std::max(maxCompressRatio_, ratio) : ratio;
+
+    ++compressCount_;
+    compressInSize_ += size;
+    compressOutSize_ += compressedSize;
+    compressInBytes_->add(size);
+    compressOutBytes_->add(compressedSize);
+}
 
 void TransportStatistics::report(std::ostream& out, const char* indent) const {
 
     reportTime(out, "    -- Waiting for buffer", waitTiming_, indent);
+    reportTime(out, "    -- Waiting for credit", creditTiming_, indent);
 
     reportCount(out, "    -- Send count (async)", isendCount_, indent);
     reportBytes(out, "    -- Sending data (async)", isendSize_, indent);
@@ -23,6 +66,18 @@ void TransportStatistics::report(std::ostream& out, const char* indent) const {
 
     reportTime(out, "    -- Serialise data", encodeTiming_, indent);
 
+    if (compressCount_ || incompressibleCount_) {
+        reportCount(out, "    -- Compressed buffers", compressCount_, indent);
+        reportCount(out, "    -- Incompressible buffers", incompressibleCount_, indent);
+        reportBytes(out, "    -- Compressing data", compressInSize_, indent);
+        reportBytes(out, "    -- Compressed data", compressOutSize_, indent);
+        if (compressOutSize_) {
+            out << indent << "    -- Compression ratio: " << static_cast<double>(compressInSize_) / compressOutSize_
+                << " (per buffer min " << minCompressRatio_ << ", max " << maxCompressRatio_ << ")" << std::endl;
+        }
+        reportTime(out, "    -- Compress time", compressTiming_, indent);
+    }
+
     reportTime(out, "    -- Probing for data", probeTiming_, indent);
     reportCount(out, "    -- Receive count", receiveCount_, indent);
     reportBytes(out, "    -- Receiving data", receiveSize_, indent);
@@ -32,6 +87,9 @@ void TransportStatistics::report(std::ostream& out, const char* indent) const {
     }
 
     reportTime(out, "    -- Push-queue timing", pushToQueueTiming_, indent);
+    if (decompressTiming_.updates_) {
+        reportTime(out, "    -- Decompress time", decompressTiming_, indent);
+    }
     reportTime(out, "    -- Deserialise data", decodeTiming_, indent);
     reportTime(out, "    -- Returning data", returnTiming_, indent);
     reportTime(out, "    -- Total for return", totReturnTiming_, indent);
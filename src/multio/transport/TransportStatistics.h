@@ -6,6 +6,8 @@
 
 #include <eckit/log/Statistics.h>
 
+#include "multio/util/Metrics.h"
+
 namespace multio {
 namespace transport {
 
@@ -22,6 +24,14 @@ public:
     std::size_t receiveCount_ = 0;
     std::size_t receiveSize_ = 0;
 
+    // Buffers sent compressed, with their sizes before and after, and buffers that did not compress enough
+    std::size_t compressCount_ = 0;
+    std::size_t compressInSize_ = 0;
+    std::size_t compressOutSize_ = 0;
+    std::size_t incompressibleCount_ = 0;
+    double minCompressRatio_ = 0.0;
+    double maxCompressRatio_ = 0.0;
+
     eckit::Timing waitTiming_;
     eckit::Timer waitTimer_;
 
@@ -53,6 +63,37 @@ public:
     eckit::Timing totReturnTiming_;
     eckit::Timer totReturnTimer_;
 
+    eckit::Timing creditTiming_;
+    eckit::Timer creditTimer_;
+
+    eckit::Timing compressTiming_;
+    eckit::Timer compressTimer_;
+
+    eckit::Timing decompressTiming_;
+    eckit::Timer decompressTimer_;
+
+    // Latency distributions per transport stage and byte counts, exported through util::Metrics
+    util::Histogram* waitLatency_;
+    util::Histogram* isendLatency_;
+    util::Histogram* sendLatency_;
+    util::Histogram* encodeLatency_;
+    util::Histogram* probeLatency_;
+    util::Histogram* receiveLatency_;
+    util::Histogram* pushToQueueLatency_;
+    util::Histogram* decodeLatency_;
+    util::Histogram* returnLatency_;
+    util::Histogram* creditLatency_;
+    util::Histogram* compressLatency_;
+    util::Histogram* decompressLatency_;
+
+    util::Counter* sentBytes_;
+    util::Counter* receivedBytes_;
+    util::Counter* compressInBytes_;
+    util::Counter* compressOutBytes_;
+
+    // A compressed size of 0 stands for a buffer sent uncompressed
+    void recordCompression(std::size_t size, std::size_t compressedSize);
+
     void report(std::ostream &out, const char* indent = "") const;
 };
 
@@ -0,0 +1,120 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "Arena.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace multio {
+namespace util {
+
+namespace {
+const size_t alignment = 64;
+const size_t hugePageSize = 2 * 1024 * 1024;
+
+size_t roundUp(size_t value, size_t multiple) {
+    return ((value + multiple - 1) / multiple) * multiple;
+}
+}  // namespace
+
+Arena::Arena(size_t chunkSize, bool hugePages) :
+    chunkSize_{roundUp(chunkSize, hugePages ? hugePageSize : alignment)}, hugePages_{hugePages} {
+    ASSERT(chunkSize_ > 0);
+}
+
+Arena::~Arena() {
+    for (const auto& chunk : chunks_) {
+        ::munmap(chunk.data, chunk.size);
+    }
+}
+
+Arena::Chunk Arena::newChunk(size_t bytes) const {
+    auto size = roundUp(std::max(bytes, chunkSize_), hugePages_ ? hugePageSize : alignment);
+
+    void* data = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (hugePages_) {
+        data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+    if (data == MAP_FAILED) {
+        // No reserved huge pages -- fall back to transparent huge pages, if available
+        data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED) {
+            throw eckit::FailedSystemCall("mmap", Here());
+        }
+#ifdef MADV_HUGEPAGE
+        if (hugePages_) {
+            ::madvise(data, size, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
+    return Chunk{static_cast<char*>(data), size};
+}
+
+void* Arena::allocate(size_t bytes) {
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    bytes = roundUp(std::max<size_t>(bytes, 1), alignment);
+
+    auto reusable = free_.find(bytes);
+    if (reusable != free_.end() && not reusable->second.empty()) {
+        auto ptr = reusable->second.back();
+        reusable->second.pop_back();
+        allocated_ += bytes;
+        return ptr;
+    }
+
+    if (chunks_.empty() || used_ + bytes > chunks_.back().size) {
+        chunks_.push_back(newChunk(bytes));
+        used_ = 0;
+    }
+
+    auto ptr = chunks_.back().data + used_;
+    used_ += bytes;
+    allocated_ += bytes;
+
+    return ptr;
+}
+
+void Arena::deallocate(void* ptr, size_t bytes) {
+    if (ptr == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    bytes = roundUp(std::max<size_t>(bytes, 1), alignment);
+    ASSERT(allocated_ >= bytes);
+
+    free_[bytes].push_back(ptr);
+    allocated_ -= bytes;
+}
+
+size_t Arena::allocated() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return allocated_;
+}
+
+size_t Arena::reserved() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    size_t total = 0;
+    for (const auto& chunk : chunks_) {
+        total += chunk.size;
+    }
+    return total;
+}
+
+}  // namespace util
+}  // namespace multio
@@ -0,0 +1,76 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2022
+
+#ifndef multio_util_Arena_H
+#define multio_util_Arena_H
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace multio {
+namespace util {
+
+// Allocator handing out cache-line aligned blocks from large chunks of anonymous memory. Returned blocks
+// are kept on a free list per size and handed out again for the same size; chunks are only released with
+// the arena. Fresh blocks are zero-initialised, reused ones are not.
+class Arena {
+public:
+    Arena(size_t chunkSize, bool hugePages = false);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes);
+
+    template <typename T>
+    T* allocate(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T)));
+    }
+
+    // The size must be the one the block was allocated with
+    void deallocate(void* ptr, size_t bytes);
+
+    template <typename T>
+    void deallocate(T* ptr, size_t count) {
+        deallocate(static_cast<void*>(ptr), count * sizeof(T));
+    }
+
+    size_t allocated() const;
+    size_t reserved() const;
+
+private:
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    Chunk newChunk(size_t bytes) const;
+
+    const size_t chunkSize_;
+    const bool hugePages_;
+
+    std::vector<Chunk> chunks_;
+    size_t used_ = 0;  // In the last chunk
+    size_t allocated_ = 0;
+
+    std::map<size_t, std::vector<void*>> free_;  // By rounded size
+
+    mutable std::mutex mutex_;
+};
+
+}  // namespace util
+}  // namespace multio
+
+#endif
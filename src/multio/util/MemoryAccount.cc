@@ -0,0 +1,163 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "MemoryAccount.h"
+
+#include <cctype>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Bytes.h"
+
+#include "multio/LibMultio.h"
+#include "multio/util/Metrics.h"
+#include "multio/util/logfile_name.h"
+
+namespace multio {
+namespace util {
+
+namespace {
+
+// Plans complete their steps in turn, so each step is reported by whichever completes it first
+const size_t reportedStepsKept = 1024;
+
+struct Registry {
+    std::mutex mutex;
+    std::map<std::string, std::unique_ptr<MemoryAccount>> accounts;
+
+    // Recently reported steps, oldest first
+    std::set<std::string> reportedSteps;
+    std::deque<std::string> reportedOrder;
+};
+
+Registry& registry() {
+    static Registry reg;
+    return reg;
+}
+
+size_t configuredLimit(const std::string& name) {
+    std::string var = "MULTIO_MEMORY_LIMIT_";
+    for (auto c : name) {
+        var += (c == '-') ? '_' : static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    return eckit::Resource<size_t>("multioMemoryLimit-" + name + ";$" + var, 0);
+}
+
+void raise(std::atomic<size_t>& peak, size_t value) {
+    auto current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+}  // namespace
+
+MemoryAccount& MemoryAccount::get(const std::string& subsystem) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+    auto& account = reg.accounts[subsystem];
+    if (!account) {
+        account.reset(new MemoryAccount{subsystem});
+    }
+    return *account;
+}
+
+MemoryAccount::MemoryAccount(const std::string& name) :
+    name_{name},
+    limit_{configuredLimit(name)},
+    bytesGauge_{Metrics::instance().gauge("memory_bytes", {{"subsystem", name}})},
+    objectsGauge_{Metrics::instance().gauge("memory_objects", {{"subsystem", name}})},
+    peakBytesGauge_{Metrics::instance().gauge("memory_peak_bytes", {{"subsystem", name}})} {}
+
+void MemoryAccount::add(size_t bytes, size_t objects) {
+    auto total = bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (limit_ != 0 && total > limit_) {
+        bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+        std::ostringstream oss;
+        oss << "Memory limit of " << eckit::Bytes(limit_) << " for " << name_ << " exceeded: " << eckit::Bytes(total)
+            << " requested";
+        throw eckit::UserError(oss.str(), Here());
+    }
+    auto count = objects_.fetch_add(objects, std::memory_order_relaxed) + objects;
+
+    raise(stepPeakBytes_, total);
+    raise(peakBytes_, total);
+    raise(peakObjects_, count);
+
+    bytesGauge_.set(static_cast<int64_t>(total));
+    objectsGauge_.set(static_cast<int64_t>(count));
+    peakBytesGauge_.set(static_cast<int64_t>(peakBytes()));
+}
+
+void MemoryAccount::remove(size_t bytes, size_t objects) {
+    auto total = bytes_.fetch_sub(bytes, std::memory_order_relaxed) - bytes;
+    auto count = objects_.fetch_sub(objects, std::memory_order_relaxed) - objects;
+
+    bytesGauge_.set(static_cast<int64_t>(total));
+    objectsGauge_.set(static_cast<int64_t>(count));
+}
+
+void MemoryAccount::resetStepPeak() {
+    stepPeakBytes_.store(bytes(), std::memory_order_relaxed);
+}
+
+void MemoryAccount::report(std::ostream& out) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+    for (const auto& entry : reg.accounts) {
+        const auto& account = *entry.second;
+        out << "    -- " << std::left << std::setw(20) << account.name() << " current " << eckit::Bytes(account.bytes())
+            << " in " << account.objects() << " objects, step peak " << eckit::Bytes(account.stepPeakBytes())
+            << ", peak " << eckit::Bytes(account.peakBytes()) << " in " << account.peakObjects() << " objects";
+        if (account.limit() != 0) {
+            out << ", limit " << eckit::Bytes(account.limit());
+        }
+        out << '\n';
+    }
+}
+
+void MemoryAccount::reportStep(const std::string& step) {
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock{reg.mutex};
+        if (not reg.reportedSteps.insert(step).second) {
+            return;
+        }
+        reg.reportedOrder.push_back(step);
+        if (reg.reportedOrder.size() > reportedStepsKept) {
+            reg.reportedSteps.erase(reg.reportedOrder.front());
+            reg.reportedOrder.pop_front();
+        }
+    }
+
+    std::ostringstream oss;
+    oss << " ** Memory held after " << step << '\n';
+    report(oss);
+
+    LOG_DEBUG_LIB(LibMultio) << oss.str() << std::flush;
+    std::ofstream logFile{logfile_name(), std::ios_base::app};
+    logFile << oss.str() << std::flush;
+
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock{reg.mutex};
+    for (const auto& entry : reg.accounts) {
+        entry.second->resetStepPeak();
+    }
+}
+
+}  // namespace util
+}  // namespace multio
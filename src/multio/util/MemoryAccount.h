@@ -0,0 +1,81 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2022
+
+/// Accounting of the bytes and objects held by the server's subsystems, e.g. the partial fields
+/// waiting for aggregation. Each account keeps its current values, the peak since the last step
+/// report and the peak over the whole run, which are also exported through util::Metrics.
+///
+/// Setting MULTIO_MEMORY_LIMIT_<SUBSYSTEM> (in bytes, subsystem name in upper case with '-' replaced
+/// by '_') makes any addition beyond that limit throw.
+
+#ifndef multio_util_MemoryAccount_H
+#define multio_util_MemoryAccount_H
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace multio {
+namespace util {
+
+class Gauge;
+
+class MemoryAccount {
+public:
+    // One account per subsystem, created on first use
+    static MemoryAccount& get(const std::string& subsystem);
+
+    // Writes the current and peak values of all accounts and starts new step peaks. Only the first of
+    // several calls for the same step reports, also when calls for different steps interleave.
+    static void reportStep(const std::string& step);
+
+    static void report(std::ostream& out);
+
+    MemoryAccount(const MemoryAccount&) = delete;
+    MemoryAccount& operator=(const MemoryAccount&) = delete;
+
+    void add(size_t bytes, size_t objects = 1);
+    void remove(size_t bytes, size_t objects = 1);
+
+    const std::string& name() const { return name_; }
+
+    size_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+    size_t objects() const { return objects_.load(std::memory_order_relaxed); }
+    size_t stepPeakBytes() const { return stepPeakBytes_.load(std::memory_order_relaxed); }
+    size_t peakBytes() const { return peakBytes_.load(std::memory_order_relaxed); }
+    size_t peakObjects() const { return peakObjects_.load(std::memory_order_relaxed); }
+    size_t limit() const { return limit_; }
+
+private:
+    explicit MemoryAccount(const std::string& name);
+
+    void resetStepPeak();
+
+    const std::string name_;
+    const size_t limit_;  // Zero if unlimited
+
+    std::atomic<size_t> bytes_{0};
+    std::atomic<size_t> objects_{0};
+    std::atomic<size_t> stepPeakBytes_{0};
+    std::atomic<size_t> peakBytes_{0};
+    std::atomic<size_t> peakObjects_{0};
+
+    Gauge& bytesGauge_;
+    Gauge& objectsGauge_;
+    Gauge& peakBytesGauge_;
+};
+
+}  // namespace util
+}  // namespace multio
+
+#endif
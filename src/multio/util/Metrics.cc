@@ -0,0 +1,406 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "Metrics.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/runtime/Main.h"
+
+namespace multio {
+namespace util {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t Histogram::bucket(uint64_t value) {
+    if (value < 16) {
+        return static_cast<size_t>(value);
+    }
+    auto exponent = 63 - __builtin_clzll(value);
+    auto sub = (value >> (exponent - 3)) & 7;
+    return 16 + static_cast<size_t>(exponent - 4) * 8 + static_cast<size_t>(sub);
+}
+
+uint64_t Histogram::upperBound(size_t bucket) {
+    if (bucket < 16) {
+        return bucket;
+    }
+    auto exponent = 4 + (bucket - 16) / 8;
+    auto sub = (bucket - 16) % 8;
+    if (exponent == 63 && sub == 7) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    return ((9 + sub) << (exponent - 3)) - 1;
+}
+
+void Histogram::record(uint64_t nanoseconds) {
+    buckets_[bucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    auto max = max_.load(std::memory_order_relaxed);
+    while (nanoseconds > max && !max_.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::recordSeconds(double seconds) {
+    record(seconds > 0 ? static_cast<uint64_t>(seconds * 1e9) : 0);
+}
+
+uint64_t Histogram::count() const {
+    return count_.load(std::memory_order_relaxed);
+}
+
+double Histogram::sum() const {
+    return sum_.load(std::memory_order_relaxed) * 1e-9;
+}
+
+double Histogram::max() const {
+    return max_.load(std::memory_order_relaxed) * 1e-9;
+}
+
+double Histogram::quantile(double q) const {
+    // Buckets are read one by one while other threads record, so the total is taken from the buckets themselves
+    std::array<uint64_t, bucketCount> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i != bucketCount; ++i) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+
+    auto rank = static_cast<uint64_t>(std::ceil(q * total));
+    uint64_t seen = 0;
+    for (size_t i = 0; i != bucketCount; ++i) {
+        seen += counts[i];
+        if (seen >= rank && counts[i] != 0) {
+            return std::min(upperBound(i), max_.load(std::memory_order_relaxed)) * 1e-9;
+        }
+    }
+    return max();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+#ifdef MSG_NOSIGNAL
+const int noSignal = MSG_NOSIGNAL;
+#else
+const int noSignal = 0;  // SO_NOSIGPIPE is set on the connection instead
+#endif
+
+template <typename Metric>
+Metric& lookup(std::map<std::string, std::map<Metrics::Labels, std::unique_ptr<Metric>>>& family,
+               const std::string& name, const Metrics::Labels& labels) {
+    auto& metric = family[name][labels];
+    if (!metric) {
+        metric.reset(new Metric{});
+    }
+    return *metric;
+}
+
+void writeLabels(std::ostream& out, const Metrics::Labels& process, const Metrics::Labels& labels, bool json,
+                 const std::string& extra = "") {
+    bool first = true;
+    for (const auto& map : {&process, &labels}) {
+        for (const auto& label : *map) {
+            out << (first ? "" : ",");
+            if (json) {
+                out << '"' << label.first << "\":\"" << label.second << '"';
+            }
+            else {
+                out << label.first << "=\"" << label.second << '"';
+            }
+            first = false;
+        }
+    }
+    if (!extra.empty()) {
+        out << (first ? "" : ",") << extra;
+    }
+}
+
+bool prometheusFormat() {
+    std::string format = eckit::Resource<std::string>("multioMetricsFormat;$MULTIO_METRICS_FORMAT", "json");
+    if (format != "json" && format != "prometheus") {
+        throw eckit::UserError("Unknown metrics format " + format + ", expected json or prometheus", Here());
+    }
+    return format == "prometheus";
+}
+
+std::string prometheusName(const std::string& name) {
+    std::string result = "multio_" + name;
+    for (auto& c : result) {
+        if (!std::isalnum(static_cast<unsigned char>(c))) {
+            c = '_';
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+Metrics::Metrics() :
+    processLabels_{{"host", eckit::Main::hostname()}, {"pid", std::to_string(::getpid())}},
+    file_{eckit::Resource<std::string>("multioMetricsFile;$MULTIO_METRICS_FILE", "")},
+    socket_{eckit::Resource<std::string>("multioMetricsSocket;$MULTIO_METRICS_SOCKET", "")},
+    prometheus_{prometheusFormat()},
+    interval_{eckit::Resource<long>("multioMetricsInterval;$MULTIO_METRICS_INTERVAL", 10)} {
+    if (!file_.empty() || !socket_.empty()) {
+        exporter_ = std::thread{&Metrics::run, this};
+    }
+}
+
+Metrics::~Metrics() {
+    if (exporter_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock{runMutex_};
+            stopping_ = true;
+        }
+        stop_.notify_all();
+        exporter_.join();
+    }
+}
+
+Histogram& Metrics::histogram(const std::string& name, const Labels& labels) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return lookup(histograms_, name, labels);
+}
+
+Counter& Metrics::counter(const std::string& name, const Labels& labels) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return lookup(counters_, name, labels);
+}
+
+Gauge& Metrics::gauge(const std::string& name, const Labels& labels) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return lookup(gauges_, name, labels);
+}
+
+void Metrics::writeJson(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    auto writeFamily = [&](const char* kind, const std::string& name, const Labels& labels) {
+        out << "{\"name\":\"" << name << "\",\"type\":\"" << kind << "\",\"labels\":{";
+        writeLabels(out, processLabels_, labels, true);
+        out << "}";
+    };
+
+    out << std::setprecision(9) << "{\"metrics\":[";
+    const char* sep = "";
+    for (const auto& family : histograms_) {
+        for (const auto& entry : family.second) {
+            const auto& hist = *entry.second;
+            out << sep;
+            writeFamily("histogram", family.first, entry.first);
+            out << ",\"count\":" << hist.count() << ",\"sum\":" << hist.sum() << ",\"max\":" << hist.max()
+                << ",\"quantiles\":{";
+            const char* qsep = "";
+            for (auto q : quantiles) {
+                out << qsep << "\"" << q << "\":" << hist.quantile(q);
+                qsep = ",";
+            }
+            out << "}}";
+            sep = ",";
+        }
+    }
+    for (const auto& family : counters_) {
+        for (const auto& entry : family.second) {
+            out << sep;
+            writeFamily("counter", family.first, entry.first);
+            out << ",\"value\":" << entry.second->value() << "}";
+            sep = ",";
+        }
+    }
+    for (const auto& family : gauges_) {
+        for (const auto& entry : family.second) {
+            out << sep;
+            writeFamily("gauge", family.first, entry.first);
+            out << ",\"value\":" << entry.second->value() << "}";
+            sep = ",";
+        }
+    }
+    out << "]}" << std::endl;
+}
+
+void Metrics::writePrometheus(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    out << std::setprecision(9);
+    for (const auto& family : histograms_) {
+        auto name = prometheusName(family.first) + "_seconds";
+        out << "# TYPE " << name << " summary\n";
+        for (const auto& entry : family.second) {
+            const auto& hist = *entry.second;
+            for (auto q : quantiles) {
+                std::ostringstream quantile;
+                quantile << "quantile=\"" << q << '"';
+                out << name << '{';
+                writeLabels(out, processLabels_, entry.first, false, quantile.str());
+                out << "} " << hist.quantile(q) << '\n';
+            }
+            out << name << "_sum{";
+            writeLabels(out, processLabels_, entry.first, false);
+            out << "} " << hist.sum() << '\n';
+            out << name << "_count{";
+            writeLabels(out, processLabels_, entry.first, false);
+            out << "} " << hist.count() << '\n';
+        }
+    }
+    for (const auto& family : counters_) {
+        auto name = prometheusName(family.first) + "_total";
+        out << "# TYPE " << name << " counter\n";
+        for (const auto& entry : family.second) {
+            out << name << '{';
+            writeLabels(out, processLabels_, entry.first, false);
+            out << "} " << entry.second->value() << '\n';
+        }
+    }
+    for (const auto& family : gauges_) {
+        auto name = prometheusName(family.first);
+        out << "# TYPE " << name << " gauge\n";
+        for (const auto& entry : family.second) {
+            out << name << '{';
+            writeLabels(out, processLabels_, entry.first, false);
+            out << "} " << entry.second->value() << '\n';
+        }
+    }
+    out.flush();
+}
+
+void Metrics::exportNow() const {
+    if (file_.empty()) {
+        return;
+    }
+
+    // Readers never see a partially written file
+    auto tmp = file_ + ".tmp";
+    {
+        std::ofstream out{tmp};
+        if (!out) {
+            throw eckit::CantOpenFile(tmp, Here());
+        }
+        prometheus_ ? writePrometheus(out) : writeJson(out);
+    }
+    if (std::rename(tmp.c_str(), file_.c_str()) != 0) {
+        throw eckit::FailedSystemCall("rename " + tmp + " " + file_, Here());
+    }
+}
+
+void Metrics::run() {
+    int listener = -1;
+    if (!socket_.empty()) {
+        ::sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        ASSERT(socket_.size() < sizeof(addr.sun_path));
+        std::strncpy(addr.sun_path, socket_.c_str(), sizeof(addr.sun_path) - 1);
+
+        ::unlink(socket_.c_str());
+        listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0 || ::bind(listener, reinterpret_cast<::sockaddr*>(&addr), sizeof(addr)) != 0
+            || ::listen(listener, 4) != 0) {
+            eckit::Log::warning() << "Cannot serve metrics on " << socket_ << ": " << std::strerror(errno)
+                                  << std::endl;
+            if (listener >= 0) {
+                ::close(listener);
+            }
+            listener = -1;
+        }
+    }
+
+    // Wakes up regularly to serve connections to the socket, and writes the file every interval
+    const auto tick = std::chrono::milliseconds{listener < 0 ? 1000 * std::max(interval_, 1L) : 200};
+    auto nextExport = std::chrono::steady_clock::now() + std::chrono::seconds{interval_};
+
+    std::unique_lock<std::mutex> lock{runMutex_};
+    while (!stop_.wait_for(lock, tick, [this] { return stopping_; })) {
+        lock.unlock();
+        try {
+            if (listener >= 0) {
+                ::pollfd pfd{listener, POLLIN, 0};
+                while (::poll(&pfd, 1, 0) > 0) {
+                    auto conn = ::accept(listener, nullptr, nullptr);
+                    if (conn < 0) {
+                        break;
+                    }
+#ifdef SO_NOSIGPIPE
+                    int on = 1;
+                    ::setsockopt(conn, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+                    std::ostringstream out;
+                    prometheus_ ? writePrometheus(out) : writeJson(out);
+                    auto text = out.str();
+                    for (size_t done = 0; done < text.size();) {
+                        // A scraper that hangs up early must not raise SIGPIPE and terminate the process
+                        auto n = ::send(conn, text.data() + done, text.size() - done, noSignal);
+                        if (n <= 0) {
+                            break;
+                        }
+                        done += static_cast<size_t>(n);
+                    }
+                    ::close(conn);
+                }
+            }
+            if (std::chrono::steady_clock::now() >= nextExport) {
+                exportNow();
+                nextExport += std::chrono::seconds{interval_};
+            }
+        }
+        catch (const std::exception& e) {
+            eckit::Log::warning() << "Exporting metrics failed: " << e.what() << std::endl;
+        }
+        lock.lock();
+    }
+    lock.unlock();
+
+    // Final values at shutdown
+    try {
+        exportNow();
+    }
+    catch (const std::exception& e) {
+        eckit::Log::warning() << "Exporting metrics failed: " << e.what() << std::endl;
+    }
+
+    if (listener >= 0) {
+        ::close(listener);
+        ::unlink(socket_.c_str());
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace util
+}  // namespace multio
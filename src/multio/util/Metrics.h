@@ -0,0 +1,131 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2022
+
+/// Process-wide registry of live metrics: latency histograms, counters and gauges. If one of the
+/// environment variables MULTIO_METRICS_FILE or MULTIO_METRICS_SOCKET is set, a background thread
+/// exports all metrics every MULTIO_METRICS_INTERVAL seconds (default 10), in the format given by
+/// MULTIO_METRICS_FORMAT: json (default) or prometheus.
+
+#ifndef multio_util_Metrics_H
+#define multio_util_Metrics_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace multio {
+namespace util {
+
+// Log-linear histogram of durations in nanoseconds: eight sub-buckets per power of two, i.e. values are
+// resolved to within 12.5% over the full range
+class Histogram {
+public:
+    static constexpr size_t bucketCount = 16 + 60 * 8;
+
+    void record(uint64_t nanoseconds);
+    void recordSeconds(double seconds);
+
+    uint64_t count() const;
+    double sum() const;  // In seconds
+    double max() const;  // In seconds
+
+    // Upper bound of the bucket holding the given quantile, in seconds
+    double quantile(double q) const;
+
+private:
+    static size_t bucket(uint64_t value);
+    static uint64_t upperBound(size_t bucket);
+
+    std::array<std::atomic<uint64_t>, bucketCount> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+class Counter {
+public:
+    void add(uint64_t value = 1) { value_.fetch_add(value, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+public:
+    void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    void add(int64_t value) { value_.fetch_add(value, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+class Metrics {
+public:
+    using Labels = std::map<std::string, std::string>;
+
+    static Metrics& instance();
+
+    ~Metrics();
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    // Metrics are created on first use and live as long as the process
+    Histogram& histogram(const std::string& name, const Labels& labels = Labels{});
+    Counter& counter(const std::string& name, const Labels& labels = Labels{});
+    Gauge& gauge(const std::string& name, const Labels& labels = Labels{});
+
+    void writeJson(std::ostream& out) const;
+    void writePrometheus(std::ostream& out) const;
+
+    void exportNow() const;
+
+private:
+    Metrics();
+
+    template <typename Metric>
+    using Family = std::map<std::string, std::map<Labels, std::unique_ptr<Metric>>>;
+
+    void run();
+
+    Family<Histogram> histograms_;
+    Family<Counter> counters_;
+    Family<Gauge> gauges_;
+
+    Labels processLabels_;
+
+    std::string file_;
+    std::string socket_;
+    bool prometheus_;
+    long interval_;
+
+    mutable std::mutex mutex_;
+
+    std::mutex runMutex_;
+    std::condition_variable stop_;
+    bool stopping_ = false;
+    std::thread exporter_;
+};
+
+}  // namespace util
+}  // namespace multio
+
+#endif
@@ -4,6 +4,8 @@
 
 #include "eckit/log/Statistics.h"
 
+#include "multio/util/Metrics.h"
+
 namespace multio {
 namespace util {
 
@@ -23,12 +25,19 @@ class ScopedTiming {
     eckit::Timer& timer_;
     eckit::Timing& timing_;
     eckit::Timing start_;
+    Histogram* histogram_;
 
 public:
-    ScopedTiming(eckit::Timer& timer, eckit::Timing& timing) :
-        timer_{timer}, timing_{timing}, start_{timer} {}
-
-    ~ScopedTiming() { timing_ += eckit::Timing{timer_} - start_; }
+    ScopedTiming(eckit::Timer& timer, eckit::Timing& timing, Histogram* histogram = nullptr) :
+        timer_{timer}, timing_{timing}, start_{timer}, histogram_{histogram} {}
+
+    ~ScopedTiming() {
+        auto elapsed = eckit::Timing{timer_} - start_;
+        timing_ += elapsed;
+        if (histogram_) {
+            histogram_->recordSeconds(elapsed.elapsed_);
+        }
+    }
 };
 
 }  // namespace util
@@ -0,0 +1,113 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "SnapshotFile.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace multio {
+namespace util {
+
+namespace {
+
+// Closes the file on every path out of read() and write()
+class ScopedFile {
+public:
+    explicit ScopedFile(int fd) : fd_{fd} {}
+    ~ScopedFile() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    ScopedFile(const ScopedFile&) = delete;
+    ScopedFile& operator=(const ScopedFile&) = delete;
+
+    int fd() const { return fd_; }
+
+    void close() {
+        auto fd = fd_;
+        fd_ = -1;
+        SYSCALL(::close(fd));
+    }
+
+private:
+    int fd_;
+};
+
+}  // namespace
+
+SnapshotFile::SnapshotFile(const std::string& path) : path_{path} {}
+
+std::vector<char> SnapshotFile::read() const {
+    std::vector<char> data;
+
+    ScopedFile file{::open(path_.c_str(), O_RDONLY)};
+    if (file.fd() < 0) {
+        if (errno == ENOENT) {
+            return data;
+        }
+        throw eckit::CantOpenFile(path_, Here());
+    }
+
+    struct stat st;
+    SYSCALL(::fstat(file.fd(), &st));
+    data.resize(static_cast<size_t>(st.st_size));
+
+    size_t done = 0;
+    while (done != data.size()) {
+        auto count = ::read(file.fd(), data.data() + done, data.size() - done);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            throw eckit::ReadError(path_, Here());
+        }
+        done += static_cast<size_t>(count);
+    }
+
+    return data;
+}
+
+void SnapshotFile::write(const char* data, size_t size) const {
+    const auto temporary = path_ + ".tmp";
+
+    ScopedFile file{::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+    if (file.fd() < 0) {
+        throw eckit::CantOpenFile(temporary, Here());
+    }
+
+    size_t done = 0;
+    while (done != size) {
+        auto count = ::write(file.fd(), data + done, size - done);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            throw eckit::WriteError(temporary, Here());
+        }
+        done += static_cast<size_t>(count);
+    }
+
+    // The only sync: after a crash the rename may be lost, leaving the previous snapshot in place
+    SYSCALL(::fsync(file.fd()));
+    file.close();
+    SYSCALL(::rename(temporary.c_str(), path_.c_str()));
+}
+
+}  // namespace util
+}  // namespace multio
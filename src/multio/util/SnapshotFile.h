@@ -0,0 +1,44 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2022
+
+#ifndef multio_util_SnapshotFile_H
+#define multio_util_SnapshotFile_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace multio {
+namespace util {
+
+// File holding the last snapshot of some state. A snapshot is written into a temporary file, synced once and
+// only then renamed over the previous one, so that the file always contains one complete snapshot, even if the
+// process dies while writing the next one. No file is kept open between snapshots.
+class SnapshotFile {
+public:
+    explicit SnapshotFile(const std::string& path);
+
+    // Last snapshot, empty if there is none
+    std::vector<char> read() const;
+
+    void write(const char* data, size_t size) const;
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+}  // namespace util
+}  // namespace multio
+
+#endif
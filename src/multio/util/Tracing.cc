@@ -0,0 +1,185 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "Tracing.h"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <sstream>
+
+#include "eckit/config/Resource.h"
+#include "eckit/log/Log.h"
+
+#include "multio/util/logfile_name.h"
+
+namespace multio {
+namespace util {
+
+namespace {
+
+const size_t flushSize = 1024 * 1024;
+
+std::string traceDirectory() {
+    return eckit::Resource<std::string>("multioTraceDirectory;$MULTIO_TRACE_DIR", "");
+}
+
+// Small, stable numbers read better in the viewer than hashed thread ids
+int threadId() {
+    static std::atomic<int> next{0};
+    thread_local int id = ++next;
+    return id;
+}
+
+thread_local uint64_t currentTraceId = 0;
+
+// Ids exceed the integers JSON readers represent exactly, hence they are written as hexadecimal strings
+std::string hex(uint64_t id) {
+    std::ostringstream os;
+    os << "\"0x" << std::hex << id << '"';
+    return os.str();
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Tracer::configured() {
+    const auto dir = traceDirectory();
+    if (dir.empty()) {
+        return false;
+    }
+
+    // Spans are written from destructors, which must not throw
+    if (::access(dir.c_str(), W_OK | X_OK) != 0) {
+        eckit::Log::warning() << "Tracing is disabled: cannot write to MULTIO_TRACE_DIR " << dir << std::endl;
+        return false;
+    }
+    return true;
+}
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+int64_t Tracer::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+uint64_t Tracer::newTraceId() {
+    // 32 bits tell processes apart: among ten thousand ranks, two collide with a probability of about one percent
+    static const uint64_t process = [] {
+        uint64_t hash = std::hash<std::string>{}(filename_prefix());
+        return ((hash ^ (hash >> 32)) & 0xffffffff) << 32;
+    }();
+    static std::atomic<uint64_t> counter{0};
+    return process | (++counter & 0xffffffff);
+}
+
+Tracer::Tracer() {
+    auto path = traceDirectory() + "/" + filename_prefix() + ".trace.json";
+    file_.open(path);
+    if (!file_) {
+        // Writes to the closed file do nothing
+        eckit::Log::warning() << "Tracing is disabled: cannot open " << path << std::endl;
+    }
+
+    std::ostringstream os;
+    os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << ::getpid() << ",\"args\":{\"name\":\""
+       << filename_prefix() << "\"}}";
+    file_ << "[\n";
+    append(os.str());
+}
+
+Tracer::~Tracer() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    file_ << buffer_ << "\n]\n";
+}
+
+void Tracer::append(const std::string& event) {
+    if (!first_) {
+        buffer_ += ",\n";
+    }
+    first_ = false;
+    buffer_ += event;
+
+    if (buffer_.size() > flushSize) {
+        file_ << buffer_;
+        file_.flush();
+        buffer_.clear();
+    }
+}
+
+void Tracer::complete(const char* name, uint64_t traceId, int64_t start, int64_t duration) {
+    std::ostringstream os;
+    os << "{\"name\":\"" << name << "\",\"cat\":\"multio\",\"ph\":\"X\",\"ts\":" << start << ",\"dur\":" << duration
+       << ",\"pid\":" << ::getpid() << ",\"tid\":" << threadId() << ",\"args\":{\"trace\":" << hex(traceId) << "}}";
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    append(os.str());
+}
+
+void Tracer::flowStart(uint64_t traceId, int64_t timestamp) {
+    std::ostringstream os;
+    os << "{\"name\":\"message\",\"cat\":\"multio\",\"ph\":\"s\",\"id\":" << hex(traceId) << ",\"ts\":" << timestamp
+       << ",\"pid\":" << ::getpid() << ",\"tid\":" << threadId() << "}";
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    append(os.str());
+}
+
+void Tracer::flowEnd(uint64_t traceId, int64_t timestamp) {
+    std::ostringstream os;
+    os << "{\"name\":\"message\",\"cat\":\"multio\",\"ph\":\"f\",\"bp\":\"e\",\"id\":" << hex(traceId)
+       << ",\"ts\":" << timestamp << ",\"pid\":" << ::getpid() << ",\"tid\":" << threadId() << "}";
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    append(os.str());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void TraceSpan::begin(uint64_t traceId) {
+    outer_ = currentTraceId;
+    traceId_ = traceId != 0 ? traceId : outer_;
+    currentTraceId = traceId_;
+    start_ = Tracer::now();
+}
+
+void TraceSpan::end() {
+    currentTraceId = outer_;
+    Tracer::instance().complete(name_, traceId_, start_, Tracer::now() - start_);
+}
+
+void TraceSpan::traceId(uint64_t traceId) {
+    if (start_ >= 0) {
+        traceId_ = traceId;
+        currentTraceId = traceId;
+    }
+}
+
+void TraceSpan::discard() {
+    if (start_ >= 0) {
+        currentTraceId = outer_;
+        start_ = -1;
+    }
+}
+
+uint64_t TraceSpan::current() {
+    return currentTraceId;
+}
+
+}  // namespace util
+}  // namespace multio
@@ -0,0 +1,111 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @date Oct 2022
+
+/// Optional per-message tracing. If the environment variable MULTIO_TRACE_DIR is set, every process
+/// writes the spans it records to <dir>/multio-<host>-<pid>.trace.json, in Chrome's trace-event format.
+/// The files of all processes can be concatenated into one trace and viewed in Perfetto or chrome://tracing.
+///
+/// The client stamps every message with a trace id, which ties together the spans recorded for it on
+/// the client and on the server. Spans inherit the trace id of the innermost enclosing span on the same
+/// thread, so that e.g. the encode and sink spans of an aggregated field are attributed to the message
+/// that completed it. With tracing disabled, a span costs a single branch.
+
+#ifndef multio_util_Tracing_H
+#define multio_util_Tracing_H
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+namespace multio {
+namespace util {
+
+class Tracer {
+public:
+    static bool enabled() {
+        static const bool enabled = configured();
+        return enabled;
+    }
+
+    static Tracer& instance();
+
+    // Microseconds since the epoch, comparable between processes on hosts with synchronised clocks
+    static int64_t now();
+
+    // Process-wide unique, and unique between processes with high probability
+    static uint64_t newTraceId();
+
+    ~Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    void complete(const char* name, uint64_t traceId, int64_t start, int64_t duration);
+
+    // Links the spans of one message across threads and processes
+    void flowStart(uint64_t traceId, int64_t timestamp);
+    void flowEnd(uint64_t traceId, int64_t timestamp);
+
+private:
+    Tracer();
+
+    static bool configured();
+
+    void append(const std::string& event);
+
+    std::mutex mutex_;
+    std::ofstream file_;
+    std::string buffer_;
+    bool first_ = true;
+};
+
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, uint64_t traceId = 0) : name_{name} {
+        if (Tracer::enabled()) {
+            begin(traceId);
+        }
+    }
+
+    ~TraceSpan() {
+        if (start_ >= 0) {
+            end();
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    // For spans whose message is only known at their end, e.g. when decoding
+    void traceId(uint64_t traceId);
+
+    // Drops the span, e.g. after probing without finding a message
+    void discard();
+
+    // Trace id of the innermost span on this thread
+    static uint64_t current();
+
+private:
+    void begin(uint64_t traceId);
+    void end();
+
+    const char* name_;
+    uint64_t traceId_ = 0;
+    uint64_t outer_ = 0;
+    int64_t start_ = -1;
+};
+
+}  // namespace util
+}  // namespace multio
+
+#endif
@@ -16,10 +16,15 @@
 #include <string>
 #include <fstream>
 #include <iomanip>
+#include <memory>
+#include <vector>
 
 #include "eckit/filesystem/TmpFile.h"
 #include "eckit/config/LocalConfiguration.h"
+#include "eckit/config/YAMLConfiguration.h"
 
+#include "multio/action/Action.h"
+#include "multio/message/Message.h"
 #include "multio/sink/FileSink.h"
 #include "multio/util/ConfigurationContext.h"
 
@@ -59,6 +64,39 @@ inline auto file_content(const eckit::PathName& file_path) -> std::string {
     return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
 }
 
+// Helpers for action tests
+
+// Collects whatever reaches the end of the chain
+inline auto captured() -> std::vector<message::Message>& {
+    static std::vector<message::Message> messages;
+    return messages;
+}
+
+class Capture : public action::Action {
+public:
+    using action::Action::Action;
+
+    void executeImpl(message::Message msg) const override { captured().push_back(std::move(msg)); }
+
+private:
+    void print(std::ostream& os) const override { os << "Capture"; }
+};
+
+// Makes "test-capture" available to configurations, once per test binary
+inline void registerCapture() {
+    static action::ActionBuilder<Capture> CaptureBuilder("test-capture");
+}
+
+// Builds the action of the given type and clears whatever was captured before
+inline auto makeAction(const std::string& yaml) -> std::unique_ptr<action::Action> {
+    registerCapture();
+    eckit::LocalConfiguration config{eckit::YAMLConfiguration{yaml}};
+    action::ConfigurationContext confCtx(config, config, "", "");
+    captured().clear();
+    return std::unique_ptr<action::Action>{
+        action::ActionFactory::instance().build(config.getString("type"), confCtx)};
+}
+
 }  // namespace test
 }  // namespace multio
 
@@ -0,0 +1,119 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+
+#include "multio/action/BitRounding.h"
+
+namespace multio {
+namespace test {
+
+using action::keepBitsForInformation;
+using action::roundMantissa;
+
+const double none = std::numeric_limits<double>::quiet_NaN();
+
+uint64_t trailingMantissa(double v, long keepBits) {
+    uint64_t u;
+    std::memcpy(&u, &v, sizeof(u));
+    return u & ((uint64_t{1} << (52 - keepBits)) - 1);
+}
+
+std::vector<double> smoothField(double noise) {
+    std::mt19937 gen{42};
+    std::normal_distribution<double> dis{0.0, noise};
+
+    std::vector<double> values(100000);
+    for (size_t i = 0; i != values.size(); ++i) {
+        values[i] = 280.0 + 10.0 * std::sin(1e-3 * i) + dis(gen);
+    }
+    return values;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("rounds to nearest with ties to even") {
+    // With two mantissa bits, the values between 1 and 2 are rounded to multiples of 0.25
+    std::vector<double> values{1.375, 1.125, 1.0625, 1.1875, -2.75, 1.9999, 1.0};
+    roundMantissa(values.data(), values.size(), 2, none);
+
+    std::vector<double> expected{1.5, 1.0, 1.0, 1.25, -3.0, 2.0, 1.0};
+    EXPECT(values == expected);
+
+    std::vector<float> single{3.14159265f};
+    roundMantissa(single.data(), single.size(), 7, std::numeric_limits<float>::quiet_NaN());
+    EXPECT_EQUAL(single[0], 3.140625f);
+}
+
+CASE("trailing bits are zero and the error is bounded") {
+    auto values = smoothField(0.1);
+    auto rounded = values;
+
+    const long keepBits = 10;
+    roundMantissa(rounded.data(), rounded.size(), keepBits, none);
+
+    for (size_t i = 0; i != values.size(); ++i) {
+        EXPECT_EQUAL(trailingMantissa(rounded[i], keepBits), 0);
+        EXPECT(std::fabs(rounded[i] - values[i]) <= std::fabs(values[i]) * std::ldexp(1.0, -keepBits - 1));
+    }
+}
+
+CASE("missing and non-finite values are left as they are") {
+    const double missing = 9999.123;
+    std::vector<double> values{missing, std::numeric_limits<double>::infinity(), 1.1, missing};
+    values.push_back(none);
+
+    roundMantissa(values.data(), values.size(), 0, missing);
+
+    EXPECT_EQUAL(values[0], missing);
+    EXPECT(std::isinf(values[1]));
+    EXPECT_EQUAL(values[2], 1.0);
+    EXPECT_EQUAL(values[3], missing);
+    EXPECT(std::isnan(values[4]));
+}
+
+CASE("keep bits follow the information content") {
+    auto values = smoothField(1e-6);
+
+    const auto keep90 = keepBitsForInformation(values.data(), values.size(), 0.9, none);
+    const auto keep99 = keepBitsForInformation(values.data(), values.size(), 0.99, none);
+    const auto keepAll = keepBitsForInformation(values.data(), values.size(), 1.0, none);
+
+    EXPECT(0 < keep90);
+    EXPECT(keep90 <= keep99);
+    EXPECT(keep99 <= keepAll);
+
+    // The noise carries no information, so not all bits are needed even for all of the information
+    EXPECT(keepAll < 52);
+
+    // Noisier fields have fewer bits of real information
+    auto noisy = smoothField(1e-2);
+    EXPECT(keepBitsForInformation(noisy.data(), noisy.size(), 0.99, none) < keep99);
+
+    // Without measurable information, nothing is rounded
+    std::vector<double> constant(1000, 3.7);
+    EXPECT_EQUAL(keepBitsForInformation(constant.data(), constant.size(), 0.99, none), 52);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -0,0 +1,120 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/io/compression/Compressor.h"
+#include "eckit/testing/Test.h"
+
+#include "multio/transport/BufferCodec.h"
+
+namespace multio {
+namespace test {
+
+using transport::BufferCodec;
+
+// Compressors that eckit has been built with
+std::vector<std::string> compressions() {
+    std::vector<std::string> names;
+    for (const auto& name : {"lz4", "snappy", "bzip2"}) {
+        if (eckit::CompressorFactory::instance().has(name)) {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
+std::vector<double> smoothField(size_t size) {
+    std::vector<double> values(size);
+    for (size_t i = 0; i != values.size(); ++i) {
+        values[i] = 280.0 + std::round(100.0 * std::sin(1e-3 * i)) / 100.0;
+    }
+    return values;
+}
+
+// Encodes and decodes the bytes, with a fresh decode-only codec as the receiver would
+bool roundTrip(BufferCodec& codec, const void* data, size_t size) {
+    eckit::Buffer frame{1};
+    const auto frameSize = codec.encode(data, size, frame);
+    EXPECT(frameSize > 0);
+    EXPECT(frameSize < size);
+
+    BufferCodec receiver;
+    eckit::Buffer decoded{1};
+    EXPECT_EQUAL(receiver.decode(frame.data(), frameSize, decoded), size);
+    return std::memcmp(decoded.data(), data, size) == 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("shuffled and plain frames decode to the original bytes") {
+    const auto values = smoothField(100000);
+    for (const auto& compression : compressions()) {
+        for (size_t width : {0, 4, 8}) {
+            BufferCodec codec{compression, width, 1.0};
+            EXPECT(codec.enabled());
+            EXPECT(roundTrip(codec, values.data(), values.size() * sizeof(double)));
+        }
+    }
+}
+
+CASE("trailing bytes beyond the last element survive the shuffle") {
+    const auto values = smoothField(10000);
+    const auto size = values.size() * sizeof(double) - 3;
+    for (const auto& compression : compressions()) {
+        BufferCodec codec{compression, 8, 1.0};
+        EXPECT(roundTrip(codec, values.data(), size));
+
+        // Buffers are reused across calls of different sizes
+        EXPECT(roundTrip(codec, values.data(), size / 2));
+    }
+}
+
+CASE("buffers that do not compress well enough are left as they are") {
+    std::mt19937_64 gen{7};
+    std::vector<uint64_t> noise(10000);
+    for (auto& v : noise) {
+        v = gen();
+    }
+
+    eckit::Buffer frame{1};
+    for (const auto& compression : compressions()) {
+        BufferCodec codec{compression, 8, 1.1};
+        EXPECT_EQUAL(codec.encode(noise.data(), noise.size() * sizeof(uint64_t), frame), 0);
+    }
+}
+
+CASE("a codec without compression does not encode") {
+    const auto values = smoothField(1000);
+    eckit::Buffer frame{1};
+
+    BufferCodec none{"none", 8, 1.0};
+    EXPECT(not none.enabled());
+    EXPECT_EQUAL(none.encode(values.data(), values.size() * sizeof(double), frame), 0);
+    EXPECT(not BufferCodec{}.enabled());
+}
+
+CASE("unknown compressions are rejected") {
+    EXPECT_THROWS_AS(BufferCodec("no-such-compression", 8, 1.0), eckit::UserError);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -0,0 +1,106 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/config/YAMLConfiguration.h"
+#include "eckit/testing/Test.h"
+
+#include "multio/domain/Mappings.h"
+#include "multio/message/Message.h"
+#include "multio/message/Metadata.h"
+#include "multio/server/MultioClient.h"
+#include "multio/util/ConfigurationContext.h"
+
+namespace multio {
+namespace test {
+
+using message::Message;
+using message::Metadata;
+using message::Peer;
+using server::MultioClient;
+
+// Client-side aggregation of a domain of which this client only holds half, so that the partial fields are kept
+// until the other parts arrive, which they never do here
+const long globalSize = 4;
+
+void registerPartialDomain() {
+    static bool registered = false;
+    if (registered) {
+        return;
+    }
+
+    std::vector<int32_t> indices{0, 1};
+
+    Metadata md;
+    md.set("name", "test-half-grid");
+    md.set("category", "test-domain-map");
+    md.set("representation", "unstructured");
+    md.set("globalSize", globalSize);
+    domain::Mappings::instance().add(
+        Message{Message::Header{Message::Tag::Domain, Peer{}, Peer{}, std::move(md)},
+                eckit::Buffer{reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(int32_t)}});
+    registered = true;
+}
+
+std::unique_ptr<MultioClient> makeClient() {
+    registerPartialDomain();
+    eckit::LocalConfiguration config{eckit::YAMLConfiguration{
+        std::string{"{client: {plans: [{name: aggregate, actions: [{type: aggregation}, {type: null}]}]}}"}}};
+    util::ConfigurationContext confCtx(config, config, "", "");
+    return std::unique_ptr<MultioClient>{new MultioClient{util::ClientConfigurationContext{confCtx, "client"}}};
+}
+
+Metadata fieldMetadata(long level) {
+    Metadata md;
+    md.set("name", "sst");
+    md.set("domain", "test-half-grid");
+    md.set("level", level);
+    md.set("globalSize", globalSize);
+    md.set("precision", "double");
+    return md;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("borrowed fields kept for aggregation are released when waited for") {
+    auto client = makeClient();
+
+    std::vector<double> values{1.0, 2.0};
+    client->dispatchBorrowed(fieldMetadata(1), values.data(), values.size() * sizeof(double), Message::Tag::Field);
+
+    // Returns although the aggregation still holds the partial field
+    client->waitBorrowed();
+    values[0] = 10.0;
+}
+
+CASE("batches of borrowed fields kept for aggregation return") {
+    auto client = makeClient();
+
+    std::vector<double> level2{1.0, 2.0};
+    std::vector<double> level3{3.0, 4.0};
+    auto md2 = fieldMetadata(2);
+    auto md3 = fieldMetadata(3);
+    client->dispatchBorrowed({{&md2, level2.data(), level2.size() * sizeof(double)},
+                             {&md3, level3.data(), level3.size() * sizeof(double)}},
+                            Message::Tag::Field);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -0,0 +1,175 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/testing/Test.h"
+
+#include "multio/domain/Domain.h"
+#include "multio/domain/IndexCoverage.h"
+#include "multio/message/Message.h"
+#include "multio/message/Metadata.h"
+
+namespace multio {
+namespace test {
+
+using domain::Domain;
+using domain::IndexCoverage;
+using message::Message;
+using message::Peer;
+
+template <typename T>
+Message field(const std::vector<T>& values, const std::string& precision) {
+    message::Metadata md;
+    md.set("precision", precision);
+    return Message{Message::Header{Message::Tag::Field, Peer{"client", 0}, Peer{"server", 0}, std::move(md)},
+                   eckit::Buffer{reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T)}};
+}
+
+template <typename T>
+std::vector<T> values(const Message& msg) {
+    auto data = static_cast<const T*>(msg.payload().data());
+    return std::vector<T>(data, data + msg.size() / sizeof(T));
+}
+
+// Every other point of the global domain, in reverse order -- long enough for the gathers to prefetch
+std::vector<int32_t> reversedEvenPoints(int32_t globalSize) {
+    std::vector<int32_t> def;
+    for (auto idx = globalSize - 2; idx >= 0; idx -= 2) {
+        def.push_back(idx);
+    }
+    return def;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("unstructured domains gather and scatter through their index map") {
+    const long globalSize = 100;
+    auto def = reversedEvenPoints(globalSize);
+    const auto expected = def;
+    std::unique_ptr<Domain> dom{new domain::Unstructured{std::move(def), globalSize}};
+    EXPECT_EQUAL(dom->local_size(), 50);
+    EXPECT_EQUAL(dom->global_size(), globalSize);
+
+    std::vector<double> global(globalSize);
+    for (size_t ii = 0; ii != global.size(); ++ii) {
+        global[ii] = 0.5 * ii;
+    }
+
+    std::vector<double> local;
+    dom->to_local(global, local);
+    EXPECT_EQUAL(local.size(), 50);
+    for (size_t k = 0; k != local.size(); ++k) {
+        EXPECT_EQUAL(local[k], 0.5 * expected[k]);
+    }
+
+    auto aggregated = field(std::vector<double>(globalSize, -1.0), "double");
+    dom->to_global(field(local, "double"), aggregated);
+    const auto result = values<double>(aggregated);
+    for (size_t ii = 0; ii != result.size(); ++ii) {
+        EXPECT_EQUAL(result[ii], (ii % 2 == 0 ? global[ii] : -1.0));
+    }
+}
+
+CASE("unstructured domains scatter single-precision fields") {
+    std::unique_ptr<Domain> dom{new domain::Unstructured{{3, 0, 2}, 4}};
+
+    auto aggregated = field(std::vector<float>(4, 0.0f), "single");
+    dom->to_global(field(std::vector<float>{1.5f, 2.5f, 3.5f}, "single"), aggregated);
+    EXPECT(values<float>(aggregated) == (std::vector<float>{2.5f, 0.0f, 3.5f, 1.5f}));
+}
+
+CASE("unstructured domains map masks of one byte per point") {
+    std::unique_ptr<Domain> dom{new domain::Unstructured{{3, 0, 2}, 4}};
+
+    std::vector<bool> bmask(4, false);
+    dom->to_bitmask(field(std::vector<uint8_t>{1, 0, 7}, "double"), bmask);
+    EXPECT(bmask == (std::vector<bool>{false, false, true, true}));
+
+    EXPECT_THROWS_AS(dom->to_bitmask(field(std::vector<uint8_t>{1, 0}, "double"), bmask), eckit::SeriousBug);
+}
+
+CASE("unstructured domains report the indices they cover") {
+    std::unique_ptr<Domain> dom{new domain::Unstructured{{3, 0, 2}, 4}};
+
+    IndexCoverage coverage{4};
+    dom->collectIndices(field(std::vector<double>(3), "double"), coverage);
+    EXPECT_EQUAL(coverage.count(), 3);
+    EXPECT(coverage.insert(1));
+
+    EXPECT_THROWS_AS(dom->collectIndices(field(std::vector<double>(4), "double"), coverage), eckit::SeriousBug);
+}
+
+// Truncation T3: zonal wavenumbers 0, 1, 2 and 3 hold 8, 6, 4 and 2 values, starting at 0, 8, 14 and 18
+CASE("spectral domains map the coefficients of their zonal wavenumbers") {
+    std::unique_ptr<Domain> first{new domain::Spectral{{3, 0, 3}}};
+    std::unique_ptr<Domain> second{new domain::Spectral{{3, 2, 1}}};
+    EXPECT_EQUAL(first->local_size(), 10);
+    EXPECT_EQUAL(second->local_size(), 10);
+    EXPECT_EQUAL(first->global_size(), 20);
+
+    std::vector<double> global(20);
+    for (size_t ii = 0; ii != global.size(); ++ii) {
+        global[ii] = ii;
+    }
+
+    std::vector<double> local;
+    second->to_local(global, local);
+    EXPECT(local == (std::vector<double>{14, 15, 16, 17, 8, 9, 10, 11, 12, 13}));
+
+    auto aggregated = field(std::vector<double>(20, -1.0), "double");
+    for (const auto& dom : {first.get(), second.get()}) {
+        dom->to_local(global, local);
+        dom->to_global(field(local, "double"), aggregated);
+    }
+    EXPECT(values<double>(aggregated) == global);
+}
+
+CASE("spectral domains scatter single-precision fields") {
+    std::unique_ptr<Domain> dom{new domain::Spectral{{1, 1}}};
+
+    auto aggregated = field(std::vector<float>(6, 0.0f), "single");
+    dom->to_global(field(std::vector<float>{1.5f, 2.5f}, "single"), aggregated);
+    EXPECT(values<float>(aggregated) == (std::vector<float>{0.0f, 0.0f, 0.0f, 0.0f, 1.5f, 2.5f}));
+}
+
+CASE("spectral domains must not share zonal wavenumbers") {
+    std::unique_ptr<Domain> first{new domain::Spectral{{3, 0, 3}}};
+    std::unique_ptr<Domain> second{new domain::Spectral{{3, 3, 1}}};
+
+    IndexCoverage coverage{20};
+    first->collectIndices(field(std::vector<double>(10), "double"), coverage);
+    EXPECT_EQUAL(coverage.count(), 10);
+    EXPECT_THROWS_AS(second->collectIndices(field(std::vector<double>(8), "double"), coverage), eckit::SeriousBug);
+
+    EXPECT_THROWS_AS(first->collectIndices(field(std::vector<double>(8), "double"), coverage), eckit::SeriousBug);
+}
+
+CASE("spectral domains reject invalid wavenumbers and masks") {
+    EXPECT_THROWS_AS(domain::Spectral({3, 4}), eckit::UserError);
+    EXPECT_THROWS_AS(domain::Spectral({3, -1}), eckit::UserError);
+
+    std::unique_ptr<Domain> dom{new domain::Spectral{{3, 0}}};
+    std::vector<bool> bmask(20);
+    EXPECT_THROWS_AS(dom->to_bitmask(field(std::vector<uint8_t>(8), "double"), bmask), eckit::UserError);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
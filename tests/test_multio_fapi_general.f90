@@ -201,6 +201,24 @@ contains
         end if
     end function
 
+    function test_nocopy_requires_contiguous_data() result(success)
+
+        ! Test that non-contiguous arrays, which could only be referenced through a temporary copy, are rejected
+
+        logical :: success
+        type(multio_handle) :: mio
+        type(multio_metadata) :: md
+        real(8), dimension(8) :: values
+
+        success = .true.
+        values = 0
+
+        if (mio%write_field_nocopy(md, values(1:8:2), 4) == MULTIO_SUCCESS) then
+            write(error_unit, *) 'multio_write_field_nocopy succeeded unexpectedly with a strided section'
+            success = .false.
+        end if
+    end function
+
     subroutine test_error_handler(context, error)
         integer(8), intent(inout) :: context
         integer, intent(in) :: error
@@ -230,6 +248,7 @@ program fapi_general
     success = success .and. test_git_sha1()
     success = success .and. test_error_handling()
     success = success .and. test_multio_set_failure_handler()
+    success = success .and. test_nocopy_requires_contiguous_data()
 
     if (.not. success) stop -1
 
@@ -0,0 +1,157 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "eccodes.h"
+
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/testing/Test.h"
+
+#include "multio/action/GribEncoder.h"
+#include "multio/action/SimplePacking.h"
+#include "multio/message/Metadata.h"
+
+namespace multio {
+namespace test {
+
+using action::GribEncoder;
+
+/// The native simple packing must produce exactly the message that ecCodes produces itself
+
+codes_handle* sample(long bitsPerValue) {
+    auto h = codes_grib_handle_new_from_samples(nullptr, "GRIB2");
+    ASSERT(h);
+    CODES_CHECK(codes_set_long(h, "bitsPerValue", bitsPerValue), nullptr);
+    return h;
+}
+
+size_t numberOfPoints() {
+    auto h = sample(16);
+    long n = 0;
+    CODES_CHECK(codes_get_long(h, "numberOfDataPoints", &n), nullptr);
+    codes_handle_delete(h);
+    return static_cast<size_t>(n);
+}
+
+std::vector<double> field(double offset, double amplitude) {
+    std::vector<double> values(numberOfPoints());
+    for (size_t i = 0; i != values.size(); ++i) {
+        values[i] = offset + amplitude * std::sin(0.37 * i) * std::cos(0.011 * i * i);
+    }
+    return values;
+}
+
+std::string encodeWithEccodes(const std::vector<double>& values, long bitsPerValue) {
+    auto h = sample(bitsPerValue);
+    CODES_CHECK(codes_set_double_array(h, "values", values.data(), values.size()), nullptr);
+
+    const void* msg = nullptr;
+    size_t size = 0;
+    CODES_CHECK(codes_get_message(h, &msg, &size), nullptr);
+    std::string encoded{static_cast<const char*>(msg), size};
+
+    codes_handle_delete(h);
+    return encoded;
+}
+
+std::string encode(GribEncoder& encoder, const std::vector<double>& values) {
+    auto msg = encoder.encodeField(message::Metadata{}, values.data(), values.size());
+    return std::string{static_cast<const char*>(msg.payload().data()), msg.size()};
+}
+
+void checkDecoded(const std::string& encoded, const std::vector<double>& values) {
+    auto h = codes_handle_new_from_message(nullptr, encoded.data(), encoded.size());
+    EXPECT(h != nullptr);
+
+    long binaryScaleFactor = 0;
+    CODES_CHECK(codes_get_long(h, "binaryScaleFactor", &binaryScaleFactor), nullptr);
+
+    std::vector<double> decoded(values.size());
+    size_t size = decoded.size();
+    CODES_CHECK(codes_get_double_array(h, "values", decoded.data(), &size), nullptr);
+    EXPECT_EQUAL(size, values.size());
+
+    const double tolerance = std::ldexp(1.0, binaryScaleFactor) * 0.5 * (1 + 1e-9);
+    for (size_t i = 0; i != values.size(); ++i) {
+        EXPECT(std::fabs(decoded[i] - values[i]) <= tolerance);
+    }
+
+    codes_handle_delete(h);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("native simple packing matches ecCodes") {
+    for (long bitsPerValue : {1, 5, 8, 12, 16, 18, 24, 31, 32}) {
+        for (auto offset : {-40.0, 0.0, 273.15, 101325.0}) {
+            for (auto amplitude : {1e-3, 1.0, 25.0, 5e4}) {
+                auto values = field(offset, amplitude);
+
+                GribEncoder encoder{sample(bitsPerValue), eckit::LocalConfiguration{}};
+                auto encoded = encode(encoder, values);
+
+                EXPECT(encoded == encodeWithEccodes(values, bitsPerValue));
+                checkDecoded(encoded, values);
+            }
+        }
+    }
+}
+
+CASE("encoder can be reused after native packing") {
+    GribEncoder encoder{sample(16), eckit::LocalConfiguration{}};
+
+    for (auto offset : {0.0, 280.0, -3.5}) {
+        auto values = field(offset, 10.0);
+        EXPECT(encode(encoder, values) == encodeWithEccodes(values, 16));
+    }
+
+}
+
+CASE("constant fields go through ecCodes") {
+    GribEncoder encoder{sample(16), eckit::LocalConfiguration{}};
+
+    std::vector<double> constant(numberOfPoints(), 42.0);
+    EXPECT(encode(encoder, constant) == encodeWithEccodes(constant, 16));
+}
+
+CASE("fields that need ecCodes are left to it") {
+    action::SimplePacking packing;
+
+    auto values = field(0.0, 1.0);
+    EXPECT(action::computeSimplePacking(values.data(), values.size(), 16, packing));
+    EXPECT(packing.referenceValue <= *std::min_element(values.begin(), values.end()));
+
+    EXPECT(not action::computeSimplePacking(values.data(), values.size(), 0, packing));
+    EXPECT(not action::computeSimplePacking(values.data(), values.size(), 48, packing));
+
+    values[7] = std::nan("");
+    EXPECT(not action::computeSimplePacking(values.data(), values.size(), 16, packing));
+
+    values[7] = HUGE_VAL;
+    EXPECT(not action::computeSimplePacking(values.data(), values.size(), 16, packing));
+
+    std::vector<double> constant(10, 3.0);
+    EXPECT(not action::computeSimplePacking(constant.data(), constant.size(), 16, packing));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -0,0 +1,174 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+
+#include "multio/action/Action.h"
+#include "multio/domain/Bitmask.h"
+#include "multio/domain/Mappings.h"
+#include "multio/domain/Mask.h"
+#include "multio/message/Message.h"
+#include "multio/message/Metadata.h"
+
+#include "TestHelpers.h"
+
+namespace multio {
+namespace test {
+
+using action::Action;
+using domain::Bitmask;
+using message::Message;
+using message::Metadata;
+using message::Peer;
+
+std::unique_ptr<Action> makeMask(const std::string& options) {
+    return makeAction("{type: mask, " + options + ", next: {type: test-capture}}");
+}
+
+// Three words: all sea, all land, and two points of which only the first is sea
+const long globalSize = 130;
+
+bool isSea(size_t idx) {
+    return idx < 64 || idx == 128;
+}
+
+// A single client holding the whole grid
+void registerMask(long level) {
+    static bool registered = false;
+    if (not registered) {
+        std::vector<int32_t> indices(globalSize);
+        for (size_t ii = 0; ii != indices.size(); ++ii) {
+            indices[ii] = ii;
+        }
+
+        Metadata md;
+        md.set("name", "test-grid");
+        md.set("category", "test-domain-map");
+        md.set("representation", "unstructured");
+        md.set("globalSize", globalSize);
+        domain::Mappings::instance().add(
+            Message{Message::Header{Message::Tag::Domain, Peer{"client", 0}, Peer{"server", 0}, std::move(md)},
+                    eckit::Buffer{reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(int32_t)}});
+        registered = true;
+    }
+
+    std::vector<uint8_t> bytes(globalSize);
+    for (size_t ii = 0; ii != bytes.size(); ++ii) {
+        bytes[ii] = isSea(ii) ? 1 : 0;
+    }
+
+    Metadata md;
+    md.set("name", "lsm");
+    md.set("domain", "test-grid");
+    md.set("level", level);
+    md.set("globalSize", globalSize);
+    domain::Mask::instance().add(
+        Message{Message::Header{Message::Tag::Mask, Peer{"client", 0}, Peer{"server", 0}, std::move(md)},
+                eckit::Buffer{reinterpret_cast<const char*>(bytes.data()), bytes.size()}});
+}
+
+template <typename T>
+Message field(const std::string& name, long level, const std::string& precision) {
+    std::vector<T> values(globalSize);
+    for (size_t ii = 0; ii != values.size(); ++ii) {
+        values[ii] = ii;
+    }
+
+    Metadata md;
+    md.set("name", name);
+    md.set("domain", "test-grid");
+    md.set("level", level);
+    md.set("globalSize", globalSize);
+    md.set("precision", precision);
+    return Message{Message::Header{Message::Tag::Field, Peer{"client", 0}, Peer{"server", 0}, std::move(md)},
+                   eckit::Buffer{reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T)}};
+}
+
+template <typename T>
+const T* values(const Message& msg) {
+    EXPECT_EQUAL(msg.size(), globalSize * sizeof(T));
+    return static_cast<const T*>(msg.payload().data());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("bits are packed into words from the lowest bit") {
+    std::vector<bool> bits(globalSize, false);
+    for (auto idx : {0, 63, 64, 129}) {
+        bits[idx] = true;
+    }
+
+    Bitmask bitmask{bits};
+    EXPECT_EQUAL(bitmask.size(), globalSize);
+    EXPECT(bitmask.words() == (std::vector<uint64_t>{1 | (uint64_t{1} << 63), 1, 2}));
+    for (size_t idx = 0; idx != bits.size(); ++idx) {
+        EXPECT_EQUAL(bitmask[idx], bits[idx]);
+    }
+
+    EXPECT(bitmask.wetPoints() == (std::vector<int32_t>{0, 63, 64, 129}));
+    EXPECT(Bitmask{std::vector<bool>{}}.words().empty());
+}
+
+CASE("land points are masked and sea points offset in one pass") {
+    registerMask(1);
+    auto mask = makeMask("missing-value: -999, offset-fields: [sst], offset-value: 10");
+
+    mask->execute(field<double>("sst", 1, "double"));
+    mask->execute(field<double>("t", 1, "double"));
+    EXPECT_EQUAL(captured().size(), 2);
+
+    auto sst = values<double>(captured()[0]);
+    auto t = values<double>(captured()[1]);
+    for (size_t ii = 0; ii != globalSize; ++ii) {
+        EXPECT_EQUAL(sst[ii], isSea(ii) ? ii + 10.0 : -999.0);
+        EXPECT_EQUAL(t[ii], isSea(ii) ? ii : -999.0);
+    }
+
+    EXPECT_EQUAL(captured()[0].metadata().getDouble("missingValue"), -999.0);
+    EXPECT(captured()[0].metadata().getBool("bitmapPresent"));
+}
+
+CASE("without the bitmap only the sea points are offset") {
+    registerMask(2);
+    auto mask = makeMask("apply-bitmap: false, offset-fields: [sst], offset-value: 10");
+
+    mask->execute(field<double>("sst", 2, "double"));
+    auto sst = values<double>(captured().at(0));
+    for (size_t ii = 0; ii != globalSize; ++ii) {
+        EXPECT_EQUAL(sst[ii], isSea(ii) ? ii + 10.0 : ii);
+    }
+}
+
+CASE("single-precision fields are masked with a representable missing value") {
+    registerMask(3);
+    auto mask = makeMask("offset-fields: [sst], offset-value: 10");
+
+    mask->execute(field<float>("sst", 3, "single"));
+    auto sst = values<float>(captured().at(0));
+    for (size_t ii = 0; ii != globalSize; ++ii) {
+        EXPECT_EQUAL(sst[ii], isSea(ii) ? ii + 10.0f : std::numeric_limits<float>::max());
+    }
+    EXPECT_EQUAL(captured()[0].metadata().getDouble("missingValue"), std::numeric_limits<float>::max());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -0,0 +1,95 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdlib>
+
+#include "eckit/testing/Test.h"
+
+#include "multio/util/MemoryAccount.h"
+
+namespace multio {
+namespace test {
+
+using util::MemoryAccount;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("accounts keep current values and peaks") {
+    auto& account = MemoryAccount::get("test-peaks");
+    EXPECT(&account == &MemoryAccount::get("test-peaks"));
+
+    account.add(100);
+    account.add(50, 2);
+    EXPECT_EQUAL(account.bytes(), 150);
+    EXPECT_EQUAL(account.objects(), 3);
+
+    account.remove(120, 2);
+    account.add(10);
+    EXPECT_EQUAL(account.bytes(), 40);
+    EXPECT_EQUAL(account.objects(), 2);
+    EXPECT_EQUAL(account.peakBytes(), 150);
+    EXPECT_EQUAL(account.peakObjects(), 3);
+    EXPECT_EQUAL(account.stepPeakBytes(), 150);
+
+    account.remove(40, 2);
+}
+
+CASE("step peaks restart once per step") {
+    auto& account = MemoryAccount::get("test-steps");
+    account.add(100);
+    account.remove(90);
+
+    MemoryAccount::reportStep("test-step-1");
+    EXPECT_EQUAL(account.stepPeakBytes(), 10);
+
+    account.add(40);
+    account.remove(40);
+    MemoryAccount::reportStep("test-step-2");
+    EXPECT_EQUAL(account.stepPeakBytes(), 10);
+
+    // A late report for an earlier step does not restart the peak
+    account.add(30);
+    account.remove(30);
+    MemoryAccount::reportStep("test-step-1");
+    EXPECT_EQUAL(account.stepPeakBytes(), 40);
+    EXPECT_EQUAL(account.peakBytes(), 100);
+
+    account.remove(10);
+}
+
+CASE("additions beyond the configured limit throw") {
+    ::setenv("MULTIO_MEMORY_LIMIT_TEST_LIMITED", "100", 1);
+    auto& account = MemoryAccount::get("test-limited");
+    EXPECT_EQUAL(account.limit(), 100);
+
+    account.add(60);
+    account.add(40);
+    EXPECT_THROWS_AS(account.add(1), eckit::UserError);
+
+    // The rejected addition is not accounted
+    EXPECT_EQUAL(account.bytes(), 100);
+    EXPECT_EQUAL(account.objects(), 2);
+    EXPECT_EQUAL(account.peakBytes(), 100);
+
+    account.remove(50);
+    account.add(50);
+    EXPECT_EQUAL(account.bytes(), 100);
+
+    EXPECT_EQUAL(MemoryAccount::get("test-unlimited").limit(), 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -0,0 +1,161 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+
+#include "multio/action/Action.h"
+#include "multio/message/Message.h"
+
+#include "TestHelpers.h"
+
+namespace multio {
+namespace test {
+
+using action::Action;
+using message::Message;
+using message::Peer;
+
+// Adds one to every value, in place
+class Increment : public Action {
+public:
+    using Action::Action;
+
+    void executeImpl(Message msg) const override {
+        auto values = static_cast<double*>(msg.payload().data());
+        for (size_t ii = 0; ii != msg.size() / sizeof(double); ++ii) {
+            values[ii] += 1.0;
+        }
+        executeNext(std::move(msg));
+    }
+
+private:
+    void print(std::ostream& os) const override { os << "Increment"; }
+};
+
+static action::ActionBuilder<Increment> IncrementBuilder("test-increment");
+
+std::unique_ptr<Action> makeFanOut(const std::string& branches) {
+    return makeAction("{type: fan-out, branches: " + branches + "}");
+}
+
+Message::Header header() {
+    return Message::Header{Message::Tag::Field, Peer{"client", 0}, Peer{"server", 0}};
+}
+
+Message field(const std::vector<double>& values) {
+    return Message{header(), eckit::Buffer{reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double)}};
+}
+
+std::vector<double> values(const Message& msg) {
+    auto data = static_cast<const double*>(msg.payload().data());
+    return std::vector<double>(data, data + msg.size() / sizeof(double));
+}
+
+const void* data(const Message& msg) {
+    return msg.payload().data();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("a shared payload is copied by the sharer that modifies it") {
+    auto original = field({1.0, 2.0, 3.0});
+    auto copy = original.share();
+    EXPECT(data(copy) == data(original));
+
+    static_cast<double*>(copy.payload().data())[0] = 10.0;
+    EXPECT(data(copy) != data(original));
+    EXPECT(values(original) == (std::vector<double>{1.0, 2.0, 3.0}));
+    EXPECT(values(copy) == (std::vector<double>{10.0, 2.0, 3.0}));
+
+    // Each now holds a private payload
+    const auto before = data(original);
+    static_cast<double*>(original.payload().data())[1] = 20.0;
+    EXPECT(data(original) == before);
+    EXPECT(values(copy) == (std::vector<double>{10.0, 2.0, 3.0}));
+}
+
+CASE("the last sharer of a payload modifies it in place") {
+    Message last;
+    const void* before;
+    {
+        auto original = field({1.0, 2.0, 3.0});
+        before = data(original);
+        last = original.share();
+    }
+
+    static_cast<double*>(last.payload().data())[0] = 10.0;
+    EXPECT(data(last) == before);
+    EXPECT(values(last) == (std::vector<double>{10.0, 2.0, 3.0}));
+}
+
+CASE("borrowed payloads are copied on first access and released") {
+    const std::vector<double> memory{1.0, 2.0, 3.0};
+    size_t released = 0;
+
+    Message borrowed{header(), std::make_shared<Message::BorrowedPayload>(memory.data(), memory.size() * sizeof(double),
+                                                                         [&released]() { ++released; })};
+    EXPECT(borrowed.isBorrowed());
+    EXPECT_EQUAL(borrowed.size(), memory.size() * sizeof(double));
+
+    auto copy = borrowed.share();
+    static_cast<double*>(copy.payload().data())[0] = 10.0;
+    EXPECT(not copy.isBorrowed());
+    EXPECT(borrowed.isBorrowed());
+    EXPECT_EQUAL(released, 0);
+
+    EXPECT(values(borrowed) == memory);
+    EXPECT(data(borrowed) != memory.data());
+    EXPECT(not borrowed.isBorrowed());
+    EXPECT_EQUAL(released, 1);
+
+    EXPECT(memory == (std::vector<double>{1.0, 2.0, 3.0}));
+    EXPECT(values(copy) == (std::vector<double>{10.0, 2.0, 3.0}));
+}
+
+CASE("fan-out branches modifying the payload do not affect the others") {
+    auto fanOut = makeFanOut(
+        "[{actions: [{type: test-increment}, {type: test-capture}]}, {actions: [{type: test-capture}]}, "
+        "{actions: [{type: test-increment}, {type: test-increment}, {type: test-capture}]}]");
+
+    auto msg = field({1.0, 2.0});
+    const auto before = data(msg);
+    fanOut->execute(std::move(msg));
+
+    EXPECT_EQUAL(captured().size(), 3);
+    EXPECT(values(captured()[0]) == (std::vector<double>{2.0, 3.0}));
+    EXPECT(values(captured()[1]) == (std::vector<double>{1.0, 2.0}));
+    EXPECT(values(captured()[2]) == (std::vector<double>{3.0, 4.0}));
+    EXPECT(data(captured()[1]) == before);
+}
+
+CASE("the last fan-out branch modifies the payload in place once the others are done with it") {
+    auto fanOut = makeFanOut("[{actions: [{type: test-increment}]}, {actions: [{type: test-increment}, {type: test-capture}]}]");
+
+    auto msg = field({1.0, 2.0});
+    const auto before = data(msg);
+    fanOut->execute(std::move(msg));
+
+    EXPECT_EQUAL(captured().size(), 1);
+    EXPECT(values(captured()[0]) == (std::vector<double>{2.0, 3.0}));
+    EXPECT(data(captured()[0]) == before);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -0,0 +1,189 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/testing/Test.h"
+
+#include "multio/message/Message.h"
+#include "multio/server/MessageQueue.h"
+
+namespace multio {
+namespace test {
+
+using message::Message;
+using message::Peer;
+using server::MessageQueue;
+
+Message makeMessage(Message::Tag tag, size_t client, size_t bytes = 0) {
+    return Message{Message::Header{tag, Peer{"client", client}, Peer{"server", 0}}, eckit::Buffer{bytes}};
+}
+
+Message field(size_t client, size_t bytes) {
+    return makeMessage(Message::Tag::Field, client, bytes);
+}
+
+// Emplaces on another thread, which is expected to block until the queue makes room
+class BlockedProducer {
+public:
+    BlockedProducer(MessageQueue& queue, Message&& msg) :
+        thread_{[this, &queue](Message msg) {
+                    queue.emplace(std::move(msg));
+                    done_ = true;
+                },
+                std::move(msg)} {}
+
+    ~BlockedProducer() { thread_.join(); }
+
+    bool stillBlocked() const {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return not done_;
+    }
+
+    bool doneEventually() const {
+        for (int i = 0; i != 200 && not done_; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return done_;
+    }
+
+private:
+    std::atomic<bool> done_{false};
+    std::thread thread_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("fields are bounded by their bytes") {
+    MessageQueue queue{100, 100};
+    EXPECT(queue.emplace(field(0, 48)));
+    EXPECT(queue.emplace(field(0, 48)));
+    EXPECT_EQUAL(queue.bytes(), 96);
+
+    BlockedProducer producer{queue, field(0, 48)};
+    EXPECT(producer.stillBlocked());
+
+    Message msg;
+    EXPECT_EQUAL(queue.pop(msg), 1);
+    EXPECT(producer.doneEventually());
+    EXPECT_EQUAL(queue.bytes(), 96);
+}
+
+CASE("fields are bounded by their number") {
+    MessageQueue queue{2, 0};
+    EXPECT(queue.emplace(field(0, 8)));
+    EXPECT(queue.emplace(field(0, 8)));
+
+    BlockedProducer producer{queue, field(0, 8)};
+    EXPECT(producer.stillBlocked());
+
+    Message msg;
+    queue.pop(msg);
+    EXPECT(producer.doneEventually());
+}
+
+CASE("a field larger than the byte limit is accepted by an empty queue") {
+    MessageQueue queue{100, 100};
+    EXPECT(queue.emplace(field(0, 1000)));
+    EXPECT_EQUAL(queue.bytes(), 1000);
+
+    BlockedProducer producer{queue, field(0, 8)};
+    EXPECT(producer.stillBlocked());
+
+    Message msg;
+    EXPECT_EQUAL(queue.pop(msg), 0);
+    EXPECT_EQUAL(msg.size(), 1000);
+    EXPECT(producer.doneEventually());
+}
+
+CASE("a closed queue drains and then reports the end") {
+    MessageQueue queue{100, 100};
+    EXPECT(queue.emplace(field(0, 8)));
+    queue.close();
+
+    EXPECT(queue.closed());
+    EXPECT(not queue.emplace(field(0, 8)));
+
+    Message msg;
+    EXPECT_EQUAL(queue.pop(msg), 0);
+    EXPECT_EQUAL(queue.pop(msg), -1);
+    EXPECT_EQUAL(queue.bytes(), 0);
+}
+
+CASE("closing releases blocked producers") {
+    MessageQueue queue{1, 0};
+    EXPECT(queue.emplace(field(0, 8)));
+
+    BlockedProducer producer{queue, field(0, 8)};
+    EXPECT(producer.stillBlocked());
+
+    queue.close();
+    EXPECT(producer.doneEventually());
+}
+
+CASE("control messages are not bounded") {
+    MessageQueue queue{1, 8};
+    EXPECT(queue.emplace(field(0, 8)));
+
+    EXPECT(queue.emplace(makeMessage(Message::Tag::StepComplete, 1)));
+    EXPECT(queue.emplace(makeMessage(Message::Tag::Mask, 1, 64)));
+    EXPECT_EQUAL(queue.bytes(), 72);
+}
+
+CASE("control messages overtake fields of other sources") {
+    MessageQueue queue{100, 0};
+    EXPECT(queue.emplace(field(0, 8)));
+    EXPECT(queue.emplace(field(0, 8)));
+    EXPECT(queue.emplace(makeMessage(Message::Tag::StepComplete, 1)));
+
+    Message msg;
+    queue.pop(msg);
+    EXPECT(msg.tag() == Message::Tag::StepComplete);
+    EXPECT_EQUAL(msg.source(), (Peer{"client", 1}));
+    queue.pop(msg);
+    EXPECT(msg.tag() == Message::Tag::Field);
+}
+
+CASE("messages of the same source leave in arrival order") {
+    MessageQueue queue{100, 0};
+    EXPECT(queue.emplace(makeMessage(Message::Tag::Domain, 0)));
+    EXPECT(queue.emplace(field(0, 8)));
+    EXPECT(queue.emplace(field(1, 8)));
+    EXPECT(queue.emplace(makeMessage(Message::Tag::StepComplete, 0)));
+    EXPECT(queue.emplace(makeMessage(Message::Tag::StepComplete, 1)));
+    EXPECT(queue.emplace(field(0, 8)));
+
+    std::vector<std::pair<Message::Tag, size_t>> order;
+    Message msg;
+    while (queue.pop(msg) > 0) {
+        order.emplace_back(msg.tag(), msg.source().id());
+    }
+    order.emplace_back(msg.tag(), msg.source().id());
+
+    // The step of client 0 completes after its field, that of client 1 after its own
+    const std::vector<std::pair<Message::Tag, size_t>> expected{
+        {Message::Tag::Domain, 0},       {Message::Tag::Field, 0},        {Message::Tag::StepComplete, 0},
+        {Message::Tag::Field, 1},        {Message::Tag::StepComplete, 1}, {Message::Tag::Field, 0}};
+    EXPECT(order == expected);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
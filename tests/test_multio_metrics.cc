@@ -0,0 +1,103 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "eckit/testing/Test.h"
+
+#include "multio/util/Metrics.h"
+
+namespace multio {
+namespace test {
+
+using util::Histogram;
+
+// Quantile of a histogram holding one small and one much larger value, in nanoseconds
+double lowerQuantile(uint64_t value) {
+    Histogram histogram;
+    histogram.record(value);
+    histogram.record(uint64_t{1} << 62);
+    return histogram.quantile(0.5) * 1e9;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("small durations are counted exactly") {
+    Histogram histogram;
+    for (uint64_t ns = 0; ns != 16; ++ns) {
+        histogram.record(ns);
+    }
+
+    EXPECT_EQUAL(histogram.count(), 16);
+    EXPECT(std::abs(histogram.quantile(1.0) * 1e9 - 15.0) < 1e-6);
+    EXPECT(std::abs(histogram.quantile(0.5) * 1e9 - 7.0) < 1e-6);
+    EXPECT(std::abs(histogram.max() * 1e9 - 15.0) < 1e-6);
+    EXPECT(std::abs(histogram.sum() * 1e9 - 120.0) < 1e-6);
+}
+
+CASE("buckets resolve durations to within an eighth") {
+    for (uint64_t value = 16; value < (uint64_t{1} << 40); value = value * 3 / 2 + 1) {
+        const auto bound = lowerQuantile(value);
+        EXPECT(bound >= static_cast<double>(value) * (1 - 1e-12));
+        EXPECT(bound <= static_cast<double>(value) * 1.125 + 1);
+    }
+
+    // Bucket boundaries: the largest value of a bucket and the first of the next
+    EXPECT(lowerQuantile(17) < lowerQuantile(18));
+    EXPECT(lowerQuantile(16) == lowerQuantile(17));
+    EXPECT(lowerQuantile(32) == lowerQuantile(35));
+    EXPECT(lowerQuantile(35) < lowerQuantile(36));
+}
+
+CASE("quantiles are ordered and capped by the maximum") {
+    Histogram histogram;
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        histogram.record(i * 1000);
+    }
+
+    const auto q50 = histogram.quantile(0.5);
+    const auto q90 = histogram.quantile(0.9);
+    const auto q99 = histogram.quantile(0.99);
+
+    EXPECT(q50 <= q90);
+    EXPECT(q90 <= q99);
+    EXPECT(q99 <= histogram.max());
+    EXPECT(q50 >= 500e-6 && q50 <= 500e-6 * 1.125);
+    EXPECT(histogram.quantile(1.0) == histogram.max());
+
+    EXPECT_EQUAL(Histogram{}.quantile(0.5), 0.0);
+}
+
+CASE("metrics are exported with their labels") {
+    auto& metrics = util::Metrics::instance();
+    metrics.counter("test_metrics_counter", {{"kind", "unit"}}).add(3);
+    metrics.histogram("test_metrics_latency").recordSeconds(0.25);
+
+    std::ostringstream prometheus;
+    metrics.writePrometheus(prometheus);
+    EXPECT(prometheus.str().find("test_metrics_counter") != std::string::npos);
+    EXPECT(prometheus.str().find("kind=\"unit\"") != std::string::npos);
+
+    std::ostringstream json;
+    metrics.writeJson(json);
+    EXPECT(json.str().find("test_metrics_latency") != std::string::npos);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -0,0 +1,127 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/config/YAMLConfiguration.h"
+#include "eckit/testing/Test.h"
+
+#include "multio/action/Action.h"
+#include "multio/action/Plan.h"
+#include "multio/action/Router.h"
+#include "multio/message/Message.h"
+#include "multio/message/Metadata.h"
+#include "multio/util/ConfigurationContext.h"
+
+#include "TestHelpers.h"
+
+namespace multio {
+namespace test {
+
+using action::Action;
+using action::ConfigurationContext;
+using action::Plan;
+using action::Router;
+using message::Message;
+using message::Metadata;
+using message::Peer;
+
+std::vector<std::unique_ptr<Plan>> makePlans(const std::string& yaml) {
+    registerCapture();
+    eckit::LocalConfiguration config{eckit::YAMLConfiguration{yaml}};
+    ConfigurationContext confCtx(config, config, "", "");
+
+    std::vector<std::unique_ptr<Plan>> plans;
+    for (auto&& cfg : confCtx.subContexts("plans", util::ComponentTag::Plan)) {
+        plans.emplace_back(new Plan(std::move(cfg)));
+    }
+    return plans;
+}
+
+Message field(const std::string& name, long param) {
+    Metadata md;
+    md.set("name", name);
+    md.set("param", param);
+    return Message{Message::Header{Message::Tag::Field, Peer{"client", 0}, Peer{"server", 0}, std::move(md)}};
+}
+
+// Positions of the routed plans in the configuration
+std::vector<size_t> routed(const Router& router, const std::vector<std::unique_ptr<Plan>>& plans,
+                           const Message& msg) {
+    std::vector<size_t> indices;
+    for (auto plan : router.route(msg)) {
+        for (size_t ii = 0; ii != plans.size(); ++ii) {
+            if (plans[ii].get() == plan) {
+                indices.push_back(ii);
+            }
+        }
+    }
+    return indices;
+}
+
+const std::string plansConfig = R"({plans: [
+    {name: upper-air, actions: [{type: select, match: field, fields: [t, q]}, {type: test-capture}]},
+    {name: everything, actions: [{type: test-capture}]},
+    {name: by-param, actions: [{type: select, conditions: [{key: param, in: [130, 34]}]}, {type: test-capture}]},
+    {name: surface, actions: [{type: select, match: field, fields: [sst]}, {type: test-capture}]}
+]})";
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("messages are routed to the plans selecting them, in configuration order") {
+    const auto plans = makePlans(plansConfig);
+    const Router router{plans};
+
+    EXPECT(routed(router, plans, field("t", 130)) == (std::vector<size_t>{0, 1, 2}));
+    EXPECT(routed(router, plans, field("q", 133)) == (std::vector<size_t>{0, 1}));
+    EXPECT(routed(router, plans, field("sst", 34)) == (std::vector<size_t>{1, 2, 3}));
+
+    // Plans without a selection receive every message
+    EXPECT(routed(router, plans, field("u", 131)) == (std::vector<size_t>{1}));
+}
+
+CASE("routes are kept for later messages") {
+    const auto plans = makePlans(plansConfig);
+    const Router router{plans};
+
+    const auto& first = router.route(field("t", 130));
+    const auto& second = router.route(field("t", 130));
+    EXPECT(&first == &second);
+    EXPECT(&first != &router.route(field("q", 133)));
+}
+
+CASE("messages lacking a routing key are offered to every plan") {
+    const auto plans = makePlans(plansConfig);
+    const Router router{plans};
+
+    Metadata md;
+    md.set("name", "t");
+    Message msg{Message::Header{Message::Tag::Field, Peer{"client", 0}, Peer{"server", 0}, std::move(md)}};
+    EXPECT(routed(router, plans, msg) == (std::vector<size_t>{0, 1, 2, 3}));
+}
+
+CASE("plans without selections are not routed") {
+    const auto plans = makePlans("{plans: [{actions: [{type: test-capture}]}, {actions: [{type: test-capture}]}]}");
+    const Router router{plans};
+
+    EXPECT(routed(router, plans, field("t", 130)) == (std::vector<size_t>{0, 1}));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -0,0 +1,150 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <iterator>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+
+#include "multio/action/Action.h"
+#include "multio/message/Message.h"
+#include "multio/message/Metadata.h"
+
+#include "TestHelpers.h"
+
+namespace multio {
+namespace test {
+
+using action::Action;
+using message::Message;
+using message::Metadata;
+using message::Peer;
+
+std::unique_ptr<Action> makeSelect(const std::string& selection) {
+    return makeAction("{type: select, " + selection + ", next: {type: test-capture}}");
+}
+
+bool isSelected(const Action& select, const Metadata& md) {
+    captured().clear();
+    select.execute(Message{Message::Header{Message::Tag::Field, Peer{"client", 0}, Peer{"server", 0}, Metadata{md}}});
+    return captured().size() == 1;
+}
+
+Metadata field(const std::string& name, long param, long level) {
+    Metadata md;
+    md.set("category", "atmosphere");
+    md.set("name", name);
+    md.set("param", param);
+    md.set("levtype", "ml");
+    md.set("level", level);
+    return md;
+}
+
+std::set<std::string> activeFields(const Action& select) {
+    std::set<std::string> fields;
+    auto ins = std::inserter(fields, fields.end());
+    select.computeActiveFields(ins);
+    return fields;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("legacy match selects by name or category") {
+    auto byName = makeSelect("match: field, fields: [t, q]");
+    EXPECT(isSelected(*byName, field("t", 130, 1)));
+    EXPECT(not isSelected(*byName, field("u", 131, 1)));
+
+    auto byCategory = makeSelect("match: category, categories: [atmosphere]");
+    EXPECT(isSelected(*byCategory, field("u", 131, 1)));
+
+    EXPECT_THROWS_AS(makeSelect("match: level, levels: [1]"), eckit::SeriousBug);
+}
+
+CASE("messages lacking the matched key are not selected") {
+    Metadata unnamed;
+    unnamed.set("param", 130L);
+
+    EXPECT(not isSelected(*makeSelect("match: field, fields: [t]"), unnamed));
+    EXPECT(not isSelected(*makeSelect("match: category, categories: [atmosphere]"), unnamed));
+    EXPECT(not isSelected(*makeSelect("conditions: [{key: name, not-in: [sst]}]"), unnamed));
+}
+
+CASE("all conditions must be met") {
+    auto select = makeSelect(
+        "conditions: [{key: param, in: [130, 133]}, {key: levtype, in: [ml]}, {key: level, min: 10, max: 50}]");
+
+    EXPECT(isSelected(*select, field("t", 130, 10)));
+    EXPECT(isSelected(*select, field("q", 133, 50)));
+    EXPECT(not isSelected(*select, field("t", 130, 9)));
+    EXPECT(not isSelected(*select, field("t", 130, 51)));
+    EXPECT(not isSelected(*select, field("u", 131, 20)));
+
+    auto surface = field("t", 130, 20);
+    surface.set("levtype", "sfc");
+    EXPECT(not isSelected(*select, surface));
+
+    // A message lacking a key is not selected
+    Metadata noLevel;
+    noLevel.set("param", 130L);
+    noLevel.set("levtype", "ml");
+    EXPECT(not isSelected(*select, noLevel));
+}
+
+CASE("values are compared by their text, whatever their type") {
+    auto select = makeSelect("conditions: [{key: param, in: ['130', 133]}]");
+    EXPECT(isSelected(*select, field("t", 130, 1)));
+    EXPECT(isSelected(*select, field("q", 133, 1)));
+
+    auto textual = field("t", 0, 1);
+    textual.set("param", "130");
+    EXPECT(isSelected(*select, textual));
+}
+
+CASE("excluded values are not selected") {
+    auto select = makeSelect("conditions: [{key: level, not-in: [1, 2]}, {key: name, not-in: [sst]}]");
+    EXPECT(isSelected(*select, field("t", 130, 3)));
+    EXPECT(not isSelected(*select, field("t", 130, 2)));
+    EXPECT(not isSelected(*select, field("sst", 34, 3)));
+}
+
+CASE("several lists on the same key keep their intersection") {
+    auto select = makeSelect("conditions: [{key: name, in: [t, q, u]}, {key: name, in: [q, u, v]}]");
+    EXPECT(not isSelected(*select, field("t", 130, 1)));
+    EXPECT(isSelected(*select, field("q", 133, 1)));
+    EXPECT(not isSelected(*select, field("v", 132, 1)));
+
+    EXPECT(activeFields(*select) == (std::set<std::string>{"q", "u"}));
+}
+
+CASE("active fields are those listed") {
+    EXPECT(activeFields(*makeSelect("match: field, fields: [t, q]")) == (std::set<std::string>{"t", "q"}));
+    EXPECT(activeFields(*makeSelect("conditions: [{key: name, in: [sst]}, {key: level, max: 1}]"))
+           == (std::set<std::string>{"sst"}));
+
+    // Only excluded names cannot be reported
+    EXPECT(activeFields(*makeSelect("conditions: [{key: name, not-in: [sst]}]")).empty());
+}
+
+CASE("invalid selections are rejected") {
+    EXPECT_THROWS_AS(makeSelect("conditions: [{key: level, in: [1]}, {key: level, max: 5}]"), eckit::UserError);
+    EXPECT_THROWS_AS(makeSelect("conditions: []"), eckit::UserError);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -0,0 +1,222 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/config/YAMLConfiguration.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/TmpFile.h"
+#include "eckit/testing/Test.h"
+
+#include "multio/action/Action.h"
+#include "multio/message/Message.h"
+#include "multio/message/Metadata.h"
+#include "multio/sink/DataSink.h"
+#include "multio/util/ConfigurationContext.h"
+
+namespace multio {
+namespace test {
+
+using action::Action;
+using action::ConfigurationContext;
+using message::Message;
+using message::Peer;
+
+// Flushes wait here while the gate is closed
+struct Gate {
+    std::mutex mutex;
+    std::condition_variable opened;
+    bool open = true;
+
+    void close() {
+        std::lock_guard<std::mutex> lock{mutex};
+        open = false;
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            open = true;
+        }
+        opened.notify_all();
+    }
+
+    void pass() {
+        std::unique_lock<std::mutex> lock{mutex};
+        opened.wait(lock, [this]() { return open; });
+    }
+};
+
+Gate flushGate;
+std::atomic<bool> failWrites{false};
+
+// Appends its operations to the file that the triggers of the sink also write to, so that both end up in order
+class Recorder : public DataSink {
+public:
+    explicit Recorder(const util::ConfigurationContext& confCtx) :
+        DataSink(confCtx), path_{confCtx.config().getString("path")} {}
+
+    void write(eckit::message::Message message) override {
+        // Slow enough for the queue to fill up
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        if (failWrites) {
+            throw eckit::WriteError(path_, Here());
+        }
+        record("write " + std::to_string(message.length()));
+    }
+
+    void flush() override {
+        flushGate.pass();
+        record("flush");
+    }
+
+private:
+    void print(std::ostream& os) const override { os << "Recorder"; }
+
+    void record(const std::string& line) {
+        std::ofstream out{path_, std::ios::app};
+        out << line << std::endl;
+    }
+
+    std::string path_;
+};
+
+static DataSinkBuilder<Recorder> RecorderBuilder("test-recorder");
+
+std::unique_ptr<Action> makeSink(const eckit::PathName& path, const std::string& options = "") {
+    eckit::LocalConfiguration config{eckit::YAMLConfiguration{
+        "{type: sink, async-flush: true, report: false, " + options + "sinks: [{type: test-recorder, path: '"
+        + path.asString() + "'}], triggers: [{type: NotifyMetadata, key: step, file: '" + path.asString() + "'}]}"}};
+    ConfigurationContext confCtx(config, config, "", "");
+    return std::unique_ptr<Action>{action::ActionFactory::instance().build("sink", confCtx)};
+}
+
+Message field(size_t count) {
+    message::Metadata md;
+    md.set("name", "sst");
+    const std::vector<double> values(count, 1.0);
+    return Message{Message::Header{Message::Tag::Field, Peer{"client", 0}, Peer{"server", 0}, std::move(md)},
+                   eckit::Buffer{reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double)}};
+}
+
+Message stepComplete() {
+    return Message{Message::Header{Message::Tag::StepComplete, Peer{"client", 0}, Peer{"server", 0}}};
+}
+
+Message notification(const std::string& step) {
+    message::Metadata md;
+    md.set("name", step);
+    md.set("trigger", "step");
+    return Message{
+        Message::Header{Message::Tag::StepNotification, Peer{"client", 0}, Peer{"server", 0}, std::move(md)}};
+}
+
+std::vector<std::string> recorded(const eckit::PathName& path) {
+    std::vector<std::string> lines;
+    std::ifstream in{path.asString()};
+    std::string line;
+    while (std::getline(in, line)) {
+        // Events are JSON objects
+        lines.push_back(line.find("NotifyMetadata") != std::string::npos ? "trigger" : line);
+    }
+    return lines;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("writes, flushes and triggers run in the order they were queued") {
+    eckit::TmpFile log;
+    {
+        auto sink = makeSink(log);
+        sink->execute(field(1));
+        sink->execute(field(2));
+        sink->execute(stepComplete());
+        sink->execute(notification("1"));
+        sink->execute(field(3));
+    }
+
+    EXPECT(recorded(log) == (std::vector<std::string>{"write 8", "write 16", "flush", "trigger", "write 24"}));
+}
+
+CASE("the destructor completes every queued operation") {
+    eckit::TmpFile log;
+    {
+        auto sink = makeSink(log);
+        for (size_t count = 1; count <= 10; ++count) {
+            sink->execute(field(count));
+        }
+        sink->execute(stepComplete());
+    }
+
+    auto lines = recorded(log);
+    EXPECT_EQUAL(lines.size(), 11);
+    EXPECT_EQUAL(lines.back(), "flush");
+}
+
+CASE("step-complete messages block while more steps than allowed are unflushed") {
+    eckit::TmpFile log;
+    auto sink = makeSink(log, "max-unflushed-steps: 1, ");
+
+    flushGate.close();
+    sink->execute(stepComplete());
+
+    std::atomic<bool> returned{false};
+    std::thread second{[&]() {
+        sink->execute(stepComplete());
+        returned = true;
+    }};
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT(not returned);
+
+    flushGate.release();
+    second.join();
+    EXPECT(returned);
+
+    sink.reset();
+    EXPECT(recorded(log) == (std::vector<std::string>{"flush", "flush"}));
+}
+
+CASE("failures on the background thread are rethrown by the next operation") {
+    eckit::TmpFile log;
+    auto sink = makeSink(log, "max-unflushed-steps: 0, ");
+
+    failWrites = true;
+    sink->execute(field(1));
+
+    // Waits for the flush queued behind the failed write, which is dropped
+    EXPECT_THROWS(sink->execute(stepComplete()));
+    failWrites = false;
+
+    // Reported once, later operations run again
+    sink->execute(field(2));
+    sink->execute(stepComplete());
+
+    sink.reset();
+    EXPECT(recorded(log) == (std::vector<std::string>{"write 16", "flush"}));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
@@ -0,0 +1,167 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+
+#include "multio/action/Action.h"
+#include "multio/domain/Mappings.h"
+#include "multio/message/Message.h"
+#include "multio/message/Metadata.h"
+
+#include "TestHelpers.h"
+
+namespace multio {
+namespace test {
+
+using message::Message;
+using message::Peer;
+
+Message field(const std::vector<double>& values, long level = 1, size_t client = 0) {
+    message::Metadata md;
+    md.set("category", "ocean");
+    md.set("name", "sst");
+    md.set("level", level);
+    md.set("domain", "grid_T");
+    return Message{Message::Header{Message::Tag::Field, Peer{"client", client}, Peer{"server", 0}, std::move(md)},
+                   eckit::Buffer{reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double)}};
+}
+
+// Two clients holding half of a grid of four points each
+void registerHalves() {
+    static bool registered = false;
+    if (registered) {
+        return;
+    }
+
+    for (size_t client : {0, 1}) {
+        std::vector<int32_t> indices{static_cast<int32_t>(2 * client), static_cast<int32_t>(2 * client + 1)};
+
+        message::Metadata md;
+        md.set("name", "test-halves");
+        md.set("category", "test-domain-map");
+        md.set("representation", "unstructured");
+        md.set("globalSize", 4L);
+        domain::Mappings::instance().add(Message{
+            Message::Header{Message::Tag::Domain, Peer{"client", client}, Peer{"server", 0}, std::move(md)},
+            eckit::Buffer{reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(int32_t)}});
+    }
+    registered = true;
+}
+
+Message part(long step, size_t client, const std::vector<double>& values) {
+    message::Metadata md;
+    md.set("category", "ocean");
+    md.set("name", "sst");
+    md.set("level", 1L);
+    md.set("step", step);
+    md.set("domain", "test-halves");
+    md.set("globalSize", 4L);
+    return Message{Message::Header{Message::Tag::Field, Peer{"client", client}, Peer{"server", 0}, std::move(md)},
+                   eckit::Buffer{reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double)}};
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("drop mode passes changed fields and drops unchanged ones") {
+    auto action = makeAction("{type: skip-unchanged, next: {type: test-capture}}");
+
+    action->execute(field({1.0, 2.0, 3.0}));
+    action->execute(field({1.0, 2.0, 3.0}));
+    action->execute(field({1.0, 2.0, 4.0}));
+    action->execute(field({1.0, 2.0, 4.0}));
+
+    EXPECT_EQUAL(captured().size(), 2);
+    EXPECT(captured()[1].payload().size() == 3 * sizeof(double));
+    EXPECT_EQUAL(static_cast<const double*>(captured()[1].payload().data())[2], 4.0);
+}
+
+CASE("fields are told apart by their integer metadata and by their source") {
+    auto action = makeAction("{type: skip-unchanged, next: {type: test-capture}}");
+
+    // Identical bytes on different levels and from different clients are different fields
+    const std::vector<double> land(8, 0.0);
+    action->execute(field(land, 1, 0));
+    action->execute(field(land, 2, 0));
+    action->execute(field(land, 1, 1));
+    EXPECT_EQUAL(captured().size(), 3);
+
+    // Fields of several clients do not make each other look changed
+    action->execute(field(land, 1, 0));
+    action->execute(field(land, 1, 1));
+    EXPECT_EQUAL(captured().size(), 3);
+}
+
+CASE("repeating parts placed before the aggregation still complete their fields") {
+    registerHalves();
+    auto action = makeAction("{type: skip-unchanged, next: {type: aggregation, next: {type: test-capture}}}");
+
+    // The second client's part is all land and never changes
+    for (long step = 1; step <= 3; ++step) {
+        action->execute(part(step, 0, {1.0 * step, 2.0}));
+        action->execute(part(step, 1, {0.0, 0.0}));
+        EXPECT_EQUAL(captured().size(), static_cast<size_t>(step));
+    }
+
+    auto values = static_cast<const double*>(captured().back().payload().data());
+    EXPECT(std::vector<double>(values, values + 4) == (std::vector<double>{3.0, 2.0, 0.0, 0.0}));
+}
+
+CASE("whole fields are skipped") {
+    auto action = makeAction("{type: skip-unchanged, next: {type: test-capture}}");
+
+    auto whole = field({1.0, 2.0});
+    auto md = whole.metadata();
+    md.set("globalSize", 2L);
+    whole = whole.modifyMetadata(std::move(md));
+    action->execute(whole);
+    action->execute(whole);
+
+    EXPECT_EQUAL(captured().size(), 1);
+}
+
+CASE("reference mode replaces unchanged fields by notifications") {
+    auto action = makeAction("{type: skip-unchanged, mode: reference, trigger: static, next: {type: test-capture}}");
+
+    action->execute(field({5.0, 6.0}));
+    action->execute(field({5.0, 6.0}));
+
+    EXPECT_EQUAL(captured().size(), 2);
+    EXPECT(captured()[0].tag() == Message::Tag::Field);
+    EXPECT(captured()[1].tag() == Message::Tag::StepNotification);
+    EXPECT_EQUAL(captured()[1].metadata().getString("trigger"), "static");
+    EXPECT_EQUAL(captured()[1].metadata().getString("name"), "sst");
+}
+
+CASE("other messages pass through") {
+    auto action = makeAction("{type: skip-unchanged, next: {type: test-capture}}");
+
+    Message flush{Message::Header{Message::Tag::StepComplete, Peer{"client", 0}, Peer{"server", 0}}};
+    action->execute(flush);
+    action->execute(flush);
+
+    EXPECT_EQUAL(captured().size(), 2);
+}
+
+CASE("unknown modes are rejected") {
+    EXPECT_THROWS_AS(makeAction("{type: skip-unchanged, mode: ignore}"), eckit::UserError);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}
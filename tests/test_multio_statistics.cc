@@ -0,0 +1,208 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+
+#include "multio/action/Action.h"
+#include "multio/action/TemporalStatistics.h"
+#include "multio/message/Message.h"
+#include "multio/message/Metadata.h"
+
+#include "TestHelpers.h"
+
+namespace multio {
+namespace test {
+
+using action::TemporalStatistics;
+using message::Message;
+using message::Peer;
+
+// Half-hourly fields, starting at midnight
+Message field(long step, const std::vector<double>& values, long level = 1) {
+    message::Metadata md;
+    md.set("name", "sst");
+    md.set("param", "sst");
+    md.set("level", level);
+    md.set("startDate", 20200101L);
+    md.set("startTime", 0L);
+    md.set("timeStep", 1800L);
+    md.set("step", step);
+    return Message{Message::Header{Message::Tag::Field, Peer{"client", 0}, Peer{"server", 0}, std::move(md)},
+                   eckit::Buffer{reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double)}};
+}
+
+std::vector<double> result(long hours, const std::string& operation, size_t index = 0) {
+    std::vector<const Message*> matches;
+    for (const auto& msg : captured()) {
+        if (msg.tag() == Message::Tag::Field && msg.metadata().getLong("timeSpanInHours") == hours
+            && msg.metadata().getString("operation") == operation) {
+            matches.push_back(&msg);
+        }
+    }
+    EXPECT(index < matches.size());
+    auto values = static_cast<const double*>(matches[index]->payload().data());
+    return std::vector<double>(values, values + matches[index]->size() / sizeof(double));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("coarser periods merge the statistics of the finer ones") {
+    auto action = makeAction(
+        "{type: statistics, output-frequencies: [2h, 1h], operations: [average, minimum, maximum], "
+        "next: {type: test-capture}}");
+
+    action->execute(field(1, {1.0, 10.0}));
+    action->execute(field(2, {3.0, 20.0}));
+    EXPECT_EQUAL(captured().size(), 3);
+
+    action->execute(field(3, {5.0, -30.0}));
+    action->execute(field(4, {7.0, 40.0}));
+    EXPECT_EQUAL(captured().size(), 9);
+
+    // Results emitted before a reset are owned by their messages and remain valid
+    EXPECT(result(1, "average", 0) == (std::vector<double>{2.0, 15.0}));
+    EXPECT(result(1, "minimum", 0) == (std::vector<double>{1.0, 10.0}));
+    EXPECT(result(1, "maximum", 0) == (std::vector<double>{3.0, 20.0}));
+
+    EXPECT(result(1, "average", 1) == (std::vector<double>{6.0, 5.0}));
+    EXPECT(result(1, "minimum", 1) == (std::vector<double>{5.0, -30.0}));
+    EXPECT(result(1, "maximum", 1) == (std::vector<double>{7.0, 40.0}));
+
+    // Sums and counts are added up, extrema are taken over both hours
+    EXPECT(result(2, "average") == (std::vector<double>{4.0, 10.0}));
+    EXPECT(result(2, "minimum") == (std::vector<double>{1.0, -30.0}));
+    EXPECT(result(2, "maximum") == (std::vector<double>{7.0, 40.0}));
+}
+
+CASE("extrema do not depend on the initial state") {
+    auto action = makeAction(
+        "{type: statistics, output-frequencies: [1h, 2h], operations: [minimum, maximum], next: {type: test-capture}}");
+
+    for (long step = 1; step <= 4; ++step) {
+        action->execute(field(step, {100.0 + step, -100.0 - step}));
+    }
+
+    EXPECT(result(1, "minimum", 1) == (std::vector<double>{103.0, -104.0}));
+    EXPECT(result(2, "minimum") == (std::vector<double>{101.0, -104.0}));
+    EXPECT(result(2, "maximum") == (std::vector<double>{104.0, -101.0}));
+}
+
+CASE("nested frequencies are required") {
+    EXPECT_THROWS_AS(makeAction("{type: statistics, output-frequencies: [2h, 3h], operations: [average]}"),
+                     eckit::UserError);
+}
+
+CASE("at least one operation is required") {
+    EXPECT_THROWS_AS(makeAction("{type: statistics, output-frequencies: [1h], operations: []}"), eckit::UserError);
+    EXPECT_THROWS_AS(TemporalStatistics::build("hour", 1, {}, field(1, {1.0})), eckit::UserError);
+}
+
+CASE("saved state restores the accumulated statistics") {
+    const std::vector<std::string> operations{"average", "maximum"};
+    auto first = field(1, {1.0, 10.0});
+    auto second = field(2, {3.0, 20.0});
+
+    auto original = TemporalStatistics::build("hour", 2, operations, first);
+    EXPECT(original->process(first));
+    EXPECT(original->process(second));
+
+    std::vector<char> state(original->stateSize());
+    EXPECT_EQUAL(original->saveState(state.data()), state.size());
+
+    auto restored = TemporalStatistics::build("hour", 2, operations, first);
+    restored->restoreState(state.data(), state.size());
+
+    // Steps included in the snapshot are ignored when the model replays them
+    auto replayed = field(2, {1000.0, 1000.0});
+    EXPECT(restored->process(replayed));
+
+    auto third = field(3, {5.0, -30.0});
+    auto fourth = field(4, {7.0, 40.0});
+    for (auto stats : {original.get(), restored.get()}) {
+        EXPECT(stats->process(third));
+        EXPECT(not stats->process(fourth));
+    }
+
+    auto expected = original->compute(fourth);
+    auto actual = restored->compute(fourth);
+    for (const auto& op : operations) {
+        EXPECT(std::memcmp(expected.at(op).data(), actual.at(op).data(), fourth.size()) == 0);
+    }
+    EXPECT_EQUAL(static_cast<const double*>(actual.at("average").data())[1], 10.0);
+}
+
+CASE("snapshots of other operations are rejected") {
+    auto msg = field(1, {1.0, 10.0});
+    auto original = TemporalStatistics::build("hour", 1, {"average", "maximum"}, msg);
+
+    std::vector<char> state(original->stateSize());
+    original->saveState(state.data());
+
+    // Same size, other operations
+    auto other = TemporalStatistics::build("hour", 1, {"average", "minimum"}, msg);
+    EXPECT_EQUAL(other->stateSize(), state.size());
+    EXPECT_THROWS_AS(other->restoreState(state.data(), state.size()), eckit::UserError);
+
+    state[0] = 'X';
+    auto same = TemporalStatistics::build("hour", 1, {"average", "maximum"}, msg);
+    EXPECT_THROWS_AS(same->restoreState(state.data(), state.size()), eckit::SeriousBug);
+}
+
+CASE("restarted actions resume all fields from one snapshot") {
+    const std::string yaml
+        = "{type: statistics, output-frequencies: [2h], operations: [average], state-directory: test-statistics-state, "
+          "next: {type: test-capture}}";
+    const std::string snapshot = "test-statistics-state/statistics.snapshot";
+    std::remove(snapshot.c_str());
+
+    const Message stepComplete{Message::Header{Message::Tag::StepComplete, Peer{"client", 0}, Peer{"server", 0}}};
+
+    {
+        auto action = makeAction(yaml);
+        for (long step = 1; step <= 2; ++step) {
+            action->execute(field(step, {1.0 * step}, 1));
+            action->execute(field(step, {10.0 * step}, 2));
+        }
+        action->execute(stepComplete);
+    }
+
+    // Level 2 is not seen again before the next snapshot, which must still hold its state
+    {
+        auto action = makeAction(yaml);
+        action->execute(field(3, {3.0}, 1));
+        action->execute(stepComplete);
+    }
+
+    auto action = makeAction(yaml);
+    action->execute(field(4, {4.0}, 1));
+    EXPECT(result(2, "average") == (std::vector<double>{2.5}));
+
+    captured().clear();
+    action->execute(field(3, {30.0}, 2));
+    action->execute(field(4, {40.0}, 2));
+    EXPECT(result(2, "average") == (std::vector<double>{25.0}));
+
+    std::remove(snapshot.c_str());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace multio
+
+int main(int argc, char** argv) {
+    return eckit::testing::run_tests(argc, argv);
+}